@@ -0,0 +1,86 @@
+#ifndef CHUNKED_COLUMNS_H
+#define CHUNKED_COLUMNS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "CompactColumns.hpp"
+#include "WorldConfig.hpp"
+
+// Block columns in the compact format (see CompactColumns.hpp) stored in one block per chunk column,
+// each block being the columns of a world of one chunk column (chunkSize * verticalSize * chunkSize).
+// Blocks are reference-counted and shared between copies: copying the columns (for example a snapshot for undo or autosave)
+// only copies one pointer per chunk column, and a shared block is copied the first time it is written (copy-on-write).
+// Blocks are never modified while they are shared, so a copy doesn't change when the columns it was copied from are edited.
+
+
+class ChunkedColumns {
+public:
+    WorldConfig world; // Dimensions of the world the columns are in
+
+    /**
+     * @brief Create empty columns
+    **/
+    ChunkedColumns() = default;
+
+    /**
+     * @brief Split columns in chunk columns (copied)
+     * @param columns Block columns
+     * @param threadCount Number of threads to use (0: number of hardware threads)
+    **/
+    explicit ChunkedColumns(const CompactColumnsView& columns, uint32_t threadCount = 0);
+
+    /**
+     * @brief Get the columns of a chunk column
+     * @param chunk Index of the chunk column (chunkX + chunkZ * horizontalChunks)
+     * @return Columns of a world of one chunk column
+    **/
+    const CompactColumns& chunk(uint32_t chunk) const {
+        return *chunks[chunk];
+    }
+
+    /**
+     * @brief Get the columns of a chunk column to modify them (copied first if they are shared with other columns)
+     * @param chunk Index of the chunk column (chunkX + chunkZ * horizontalChunks)
+     * @return Columns of a world of one chunk column
+    **/
+    CompactColumns& writeChunk(uint32_t chunk);
+
+    /**
+     * @brief Check if a chunk column is shared with other columns (same block, no copy)
+     * @param other Other columns (same world)
+     * @param chunk Index of the chunk column (chunkX + chunkZ * horizontalChunks)
+    **/
+    bool sharesChunk(const ChunkedColumns& other, uint32_t chunk) const {
+        return chunks[chunk] == other.chunks[chunk];
+    }
+
+    /**
+     * @brief Share the columns of a chunk column (they are not modified while they are shared, writeChunk() copies them)
+     * @param chunk Index of the chunk column (chunkX + chunkZ * horizontalChunks)
+     * @return Columns of a world of one chunk column
+    **/
+    std::shared_ptr<const CompactColumns> shareChunk(uint32_t chunk) const {
+        return chunks[chunk];
+    }
+
+    /**
+     * @brief Merge the chunk columns in columns of the whole world (same columns as the ones they were split from)
+     * @return Block columns
+    **/
+    CompactColumns merge() const;
+
+    /**
+     * @brief Memory used by the columns (shared blocks included)
+     * @return Size (in bytes)
+    **/
+    size_t memorySize() const;
+
+private:
+    std::vector<std::shared_ptr<CompactColumns>> chunks; // Columns of each chunk column
+};
+
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef COLUMN_INDEX_H
+#define COLUMN_INDEX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Start index of each column in two levels: 32 bits start of each row of chunkSize columns and 16 bits start of each column relative to its row.
+// Columns must be in chunk order (index of (x, z) : (chunkX + chunkZ * horizontalChunks) * chunkSize^2 + xInChunk + zInChunk * chunkSize),
+// so a chunk is chunkSize consecutive rows.
+// A column can't start more than 65535 elements after the start of its row (always true with one element per block and chunkSize * verticalSize < 65536).
+
+
+// Read-only access to an index stored anywhere (ColumnIndex or a mapped world file)
+class ColumnIndexView {
+public:
+    const uint32_t* rowStarts; // Start of each row (one more element at the end)
+    const uint16_t* offsets; // Start of each column relative to the start of its row
+    uint32_t rowShift; // log2(chunkSize)
+
+    /**
+     * @brief Create an empty view
+    **/
+    ColumnIndexView() :
+        rowStarts(nullptr),
+        offsets(nullptr),
+        rowShift(0) {}
+
+    /**
+     * @brief Create a view of an index
+     * @param rowStarts Start of each row
+     * @param offsets Start of each column relative to the start of its row
+     * @param chunkSize Size of a chunk (power of 2)
+    **/
+    ColumnIndexView(const uint32_t* rowStarts, const uint16_t* offsets, uint32_t chunkSize) :
+        rowStarts(rowStarts),
+        offsets(offsets),
+        rowShift(__builtin_ctz(chunkSize)) {}
+
+    /**
+     * @brief Start of a column
+     * @param xzIndex Index of the column
+     * @return Index of the first element of the column
+    **/
+    uint32_t start(uint32_t xzIndex) const {
+        return rowStarts[xzIndex >> rowShift] + offsets[xzIndex];
+    }
+
+    /**
+     * @brief End of a column
+     * @param xzIndex Index of the column
+     * @return Index after the last element of the column
+    **/
+    uint32_t end(uint32_t xzIndex) const {
+        if (((xzIndex + 1) & ((1 << rowShift) - 1)) == 0) return rowStarts[(xzIndex >> rowShift) + 1];
+        return rowStarts[xzIndex >> rowShift] + offsets[xzIndex + 1];
+    }
+
+    /**
+     * @brief Same as start() and end() with the chunk size known at compile time (for inner loops)
+    **/
+    template<uint32_t chunkSize> uint32_t start(uint32_t xzIndex) const {
+        return rowStarts[xzIndex / chunkSize] + offsets[xzIndex];
+    }
+
+    template<uint32_t chunkSize> uint32_t end(uint32_t xzIndex) const {
+        if ((xzIndex + 1) % chunkSize == 0) return rowStarts[xzIndex / chunkSize + 1];
+        return rowStarts[xzIndex / chunkSize] + offsets[xzIndex + 1];
+    }
+
+    /**
+     * @brief Start of a chunk
+     * @param chunk Index of the chunk (chunkX + chunkZ * horizontalChunks)
+     * @return Index of the first element of the chunk
+    **/
+    uint32_t chunkStart(uint32_t chunk) const {
+        return rowStarts[chunk << rowShift];
+    }
+};
+
+
+class ColumnIndex {
+public:
+    std::vector<uint32_t> rowStarts; // Start of each row (one more element at the end)
+    std::vector<uint16_t> offsets; // Start of each column relative to the start of its row
+    uint32_t rowShift; // log2(chunkSize)
+
+    /**
+     * @brief Create an empty index
+    **/
+    ColumnIndex() :
+        rowShift(0) {}
+
+    /**
+     * @brief Create an index (starts are not initialized)
+     * @param chunkCount Number of chunks
+     * @param chunkSize Size of a chunk (power of 2)
+    **/
+    ColumnIndex(uint32_t chunkCount, uint32_t chunkSize) :
+        rowStarts(chunkCount * chunkSize + 1),
+        offsets(chunkCount * chunkSize * chunkSize),
+        rowShift(__builtin_ctz(chunkSize)) {}
+
+    /**
+     * @brief Read-only view of the index (invalidated if the index is resized)
+    **/
+    ColumnIndexView view() const {
+        return ColumnIndexView(rowStarts.data(), offsets.data(), 1 << rowShift);
+    }
+
+    /**
+     * @brief Start of a column
+     * @param xzIndex Index of the column
+     * @return Index of the first element of the column
+    **/
+    uint32_t start(uint32_t xzIndex) const {
+        return view().start(xzIndex);
+    }
+
+    /**
+     * @brief End of a column
+     * @param xzIndex Index of the column
+     * @return Index after the last element of the column
+    **/
+    uint32_t end(uint32_t xzIndex) const {
+        return view().end(xzIndex);
+    }
+
+    /**
+     * @brief Start of a chunk
+     * @param chunk Index of the chunk (chunkX + chunkZ * horizontalChunks)
+     * @return Index of the first element of the chunk
+    **/
+    uint32_t chunkStart(uint32_t chunk) const {
+        return view().chunkStart(chunk);
+    }
+
+    /**
+     * @brief Set the start of a column (columns of a row must be set in order)
+     * @param xzIndex Index of the column
+     * @param start Index of the first element of the column
+    **/
+    void setStart(uint32_t xzIndex, uint32_t start);
+
+    /**
+     * @brief Set the end of the last column
+     * @param end Index after the last element of the last column
+    **/
+    void setEnd(uint32_t end) {
+        rowStarts.back() = end;
+    }
+
+    /**
+     * @brief Memory used by the index
+     * @return Size (in bytes)
+    **/
+    size_t memorySize() const {
+        return rowStarts.size() * sizeof(uint32_t) + offsets.size() * sizeof(uint16_t);
+    }
+};
+
+
+#endif
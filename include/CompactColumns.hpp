@@ -0,0 +1,78 @@
+#ifndef COMPACT_COLUMNS_H
+#define COMPACT_COLUMNS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "ColumnIndex.hpp"
+#include "WorldConfig.hpp"
+
+// Compact storage of block columns (3 bytes per block).
+// Columns are in the same order as in IDIndexes: index of (x, z) : (chunkX + chunkZ * horizontalChunks) * chunkSize^2 + xInChunk + zInChunk * chunkSize
+// Blocks of column i : indices index.start(i) to index.end(i) - 1 in ys (y coordinates, ascending order) and ids (color ids).
+// Blocks from bottoms[i] to the first block of column i (excluded) are invisible (ID 0), they are not stored.
+// ID 0 can still be used in ys/ids for other invisible blocks.
+
+
+// Read-only access to columns stored anywhere (CompactColumns or a mapped world file, see WorldFile.hpp)
+class CompactColumnsView {
+public:
+    WorldConfig world; // Dimensions of the world the columns are in
+    const uint16_t* ys; // y coordinate of each block
+    const uint8_t* ids; // Color ID of each block
+    const uint16_t* bottoms; // Start of the invisible blocks below the first block of each column
+    ColumnIndexView index; // Index of the first block of each column in ys and ids
+
+    /**
+     * @brief Hash of the dimensions and blocks of the world (identifies the world, for example in a mesh cache)
+     * @return 64 bits hash
+    **/
+    uint64_t contentHash() const;
+};
+
+
+class CompactColumns {
+public:
+    WorldConfig world; // Dimensions of the world the columns are in
+    std::vector<uint16_t> ys; // y coordinate of each block
+    std::vector<uint8_t> ids; // Color ID of each block
+    std::vector<uint16_t> bottoms; // Start of the invisible blocks below the first block of each column
+    ColumnIndex index; // Index of the first block of each column in ys and ids
+
+    /**
+     * @brief Create empty columns
+    **/
+    CompactColumns() = default;
+
+    /**
+     * @brief Convert columns from the IDs format (see GenerateMesh.hpp)
+     * @param world Dimensions of the world
+     * @param IDs Block IDs
+     * @param IDIndexes Start index for each (x, z) in IDs
+    **/
+    CompactColumns(const WorldConfig& world, const int* IDs, const uint32_t* IDIndexes);
+
+    /**
+     * @brief Read-only view of the columns (invalidated if the columns are resized)
+    **/
+    CompactColumnsView view() const {
+        return CompactColumnsView { world, ys.data(), ids.data(), bottoms.data(), index.view() };
+    }
+
+    /**
+     * @brief Hash of the dimensions and blocks of the world (same as view().contentHash())
+    **/
+    uint64_t contentHash() const {
+        return view().contentHash();
+    }
+
+    /**
+     * @brief Memory used by the columns
+     * @return Size (in bytes)
+    **/
+    size_t memorySize() const;
+};
+
+
+#endif
@@ -1,9 +0,0 @@
-#ifndef CONSTANTS_H
-#define CONSTANTS_H
-
-#define HORIZONTAL_SIZE 4096
-#define VERTICAL_SIZE 512
-#define CHUNK_SIZE 64
-#define HORIZONTAL_CHUNKS HORIZONTAL_SIZE / CHUNK_SIZE
-
-#endif
\ No newline at end of file
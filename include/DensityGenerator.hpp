@@ -0,0 +1,89 @@
+#ifndef DENSITY_GENERATOR_H
+#define DENSITY_GENERATOR_H
+
+#include <cstdint>
+
+#include "NoiseGenerator.hpp"
+
+
+// 3D terrain generator (caves and overhangs) used by generateTerrain().
+// A block is solid if it is below the surface of a NoiseGenerator moved up or down by 3D noise (overhangs), and not in a cave (3D noise below a threshold).
+// Noise is evaluated for 8 columns at once with AVX2 (4 with SSE4.1, 1 without SIMD).
+// Coarse bounds of the noise skip y intervals that are entirely air or entirely solid, so most blocks are never evaluated.
+class DensityGenerator {
+public:
+    static constexpr uint32_t version = 1; // Must change when the generated blocks change (invalidates saved worlds, see WorldFile.hpp)
+
+    /**
+     * @brief Create a new 3D generator
+     * @param seed Random seed
+     * @param skipIntervals Skip the evaluation of intervals known to be air or solid (false: evaluate every block, same output)
+    **/
+    explicit DensityGenerator(uint32_t seed = 0, bool skipIntervals = true);
+
+    /**
+     * @brief Generate the solid blocks of consecutive columns in a row
+     * @param startX x of the first column
+     * @param z z of the row
+     * @param count Number of columns
+     * @param verticalSize Height of the world
+     * @param solid Output solid blocks, wordCount(verticalSize) words per column: bit y % 64 of word y / 64 is 1 if block y is solid
+    **/
+    void generate(int startX, int z, int count, int verticalSize, uint64_t* solid) const;
+
+    /**
+     * @brief Identifier of the generated terrain: version and seed (generators with the same identifier generate the same blocks)
+    **/
+    uint64_t id() const {
+        return ((uint64_t)version << 32) | seed;
+    }
+
+    /**
+     * @brief Number of 64 bits words to store a column
+     * @param verticalSize Height of the world
+    **/
+    static int wordCount(int verticalSize) {
+        return (verticalSize + 63) / 64;
+    }
+
+    /**
+     * @brief ID of a solid block
+     * @param y y of the block
+     * @param covered Whether the block above is solid
+    **/
+    static int blockID(int y, bool covered);
+
+    /**
+     * @brief Measure the generation speed on one thread
+     * @param size Size (in columns) of the square area to generate
+     * @param verticalSize Height of the area
+     * @return Generation speed (in millions of blocks per second)
+    **/
+    double benchmark(int size, int verticalSize) const;
+
+private:
+    NoiseGenerator surface;
+    uint32_t seed;
+    bool skipIntervals;
+
+    /**
+     * @brief Generate solid blocks for exactly the SIMD width of columns
+     * @param startX x of the first column
+     * @param z z of the row
+     * @param heights Heights of the surface
+     * @param verticalSize Height of the world
+     * @param solid Output solid blocks (zeros)
+    **/
+    void generateLanes(int startX, int z, const int* heights, int verticalSize, uint64_t* solid) const;
+
+    /**
+     * @brief Check if there can't be any cave in a cell of the cave noise lattice (coarse bound of the noise from the values at the corners of the cells)
+     * @param startX x of the first column
+     * @param cellY y of the cell in the lattice
+     * @param z z of the row
+    **/
+    bool caveFree(int startX, int cellY, int z) const;
+};
+
+
+#endif
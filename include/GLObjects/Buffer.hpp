@@ -111,6 +111,17 @@ public:
         glNamedBufferSubData(buffer, start * sizeof(T), n * sizeof(T), data);
     }
 
+    /**
+     * @brief Copy a part of another buffer to this buffer without resizing it (on the GPU)
+     * @param source Buffer to copy from
+     * @param n Number of elements to copy
+     * @param sourceStart First element to copy in source
+     * @param start First element to modify
+    **/
+    template<typename T> void copyData(Buffer const& source, uint32_t n, uint32_t sourceStart = 0, uint32_t start = 0) const {
+        glCopyNamedBufferSubData(source.buffer, buffer, sourceStart * sizeof(T), start * sizeof(T), n * sizeof(T));
+    }
+
     /**
      * @brief Get a part of the buffer
      * @param n Number of elements to get
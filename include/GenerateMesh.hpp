@@ -5,6 +5,15 @@
 #include <cstdint>
 
 #include "VoxelMesh.hpp"
+#include "CompactColumns.hpp"
+#include "ChunkedColumns.hpp"
+#include "PublishedColumns.hpp"
+#include "PalettedChunks.hpp"
+#include "HeightMap.hpp"
+#include "OccupancySummary.hpp"
+#include "WorldConfig.hpp"
+#include "MeshingContext.hpp"
+#include "MeshSink.hpp"
 
 // IDs contains all block rows one after the other.
 // A row contains all blocks for an (x, z) coordinate in ascending order.
@@ -12,20 +21,151 @@
 // Index of the start of each row in IDs : IDIndexes.
 // Index of a row in IDIndexes : (chunkX + chunkZ * horizontalChunks) + xInChunk + zInChunk * chunkSize
 // ID 0 : invisible block used to not render faces arround it.
+// The compact format (see CompactColumns.hpp) stores the same blocks without the invisible blocks below the first block of each row.
+// The meshes of each chunk column are its full resolution meshes followed by its meshes for each level of detail (see VoxelMesh.hpp),
+// unless they are disabled in the meshing context (see MeshingContext::levelsOfDetail()):
+// each chunk is downsampled to cells of 2, 4 and 8 blocks (a cell is solid if it contains faces, its ID is the majority ID of its faces)
+// and the downsampled grid is greedy meshed. Cells on the sides of a chunk column always have faces on the sides (skirts),
+// so that neighbour chunk columns at other levels of detail leave no cracks (except on the border of the world, which has no faces).
+
+static constexpr uint32_t mesherVersion = 2; // Must change when the generated meshes change (invalidates saved meshes, see MeshCache.hpp)
+static constexpr uint32_t lodCount = 3; // Number of downsampled levels of detail of each chunk column
 
 /**
  * @brief 
  * Generate an optimized mesh (greedy meshing) for the terrain from block IDs. 
  * The mesh will be split in chunks and different face orientations.
+ * Chunks are meshed in parallel, each thread with its own buffers, and added to the output in chunk order.
  * @param chunkStartX x start (in chunks) of the part of IDs to render
  * @param chunkStartZ z start (in chunks) of the part of IDs to render
  * @param chunkSizeX x size (in chunks) of the part of IDs to render
  * @param chunkSizeZ z size (in chunks) of the part of IDs to render
+ * @param world Dimensions of the world
  * @param IDs Block IDs
  * @param IDIndexes Start index for each (x, z) in IDs
  * @param meshes Vector to add output meshes to
  * @param squares Vector to add output squares to
+ * @param threadCount Number of threads to use (0: number of hardware threads), the output doesn't depend on it
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const WorldConfig& world, int* IDs, uint32_t* IDIndexes, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares, uint32_t threadCount = 0);
+
+/**
+ * @brief 
+ * Generate an optimized mesh (greedy meshing) for the terrain from columns in the compact format. 
+ * The mesh will be split in chunks and different face orientations (chunk size of the world of the columns). 
+ * Any rectangle of chunks inside the world can be meshed (for example to update edited chunks): 
+ * its meshes are the same as the meshes of its chunks when meshing the whole world, 
+ * and the cost only depends on the size of the rectangle. Throws a runtime_error if the rectangle is not inside the world.
+ * @param chunkStartX x start (in chunks) of the part of the columns to render
+ * @param chunkStartZ z start (in chunks) of the part of the columns to render
+ * @param chunkSizeX x size (in chunks) of the part of the columns to render
+ * @param chunkSizeZ z size (in chunks) of the part of the columns to render
+ * @param columns Block columns
+ * @param meshes Vector to add output meshes to
+ * @param squares Vector to add output squares to
+ * @param threadCount Number of threads to use (0: number of hardware threads), the output doesn't depend on it
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const CompactColumns& columns, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares, uint32_t threadCount = 0);
+
+/**
+ * @brief Same as above, from a view of columns (for example mapped from a world file, see WorldFile.hpp)
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const CompactColumnsView& columns, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares, uint32_t threadCount = 0);
+
+/**
+ * @brief 
+ * Same as above, with the buffers of the mesher kept in a context between calls (for meshing regions or edits). 
+ * Once the context and the output vectors are large enough, meshing on one thread doesn't allocate memory.
+ * @param context Buffers of the mesher (one context can't be used by several calls at the same time)
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const CompactColumnsView& columns, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares, MeshingContext& context, uint32_t threadCount = 0);
+
+/**
+ * @brief 
+ * Same as above, giving the meshes of each chunk column to a sink instead of adding them to vectors, 
+ * so that they can be written directly where they are used (for example renderer-ready arrays, see MeshSink.hpp). 
+ * With one thread, only the meshes of one chunk column are kept by the mesher at a time.
+ * @param sink Destination of the meshes (chunk columns are given in chunk order)
+ * @param occupancy Occupancy of the columns, to skip chunks without visible faces (nullptr: no summary, up to date with the columns otherwise)
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const CompactColumnsView& columns, MeshSink& sink, MeshingContext& context, uint32_t threadCount = 0, const OccupancySummary* occupancy = nullptr);
+
+/**
+ * @brief Same as above, from columns stored by chunk columns (see ChunkedColumns.hpp), the output is the same as for the merged columns
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const ChunkedColumns& columns, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares, uint32_t threadCount = 0);
+
+/**
+ * @brief Same as above, with the buffers of the mesher kept in a context and the meshes given to a sink (see MeshSink.hpp)
+ * @param sink Destination of the meshes (chunk columns are given in chunk order)
+ * @param context Buffers of the mesher (one context can't be used by several calls at the same time)
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const ChunkedColumns& columns, MeshSink& sink, MeshingContext& context, uint32_t threadCount = 0);
+
+/**
+ * @brief 
+ * Same as above, from columns published to reader threads (see PublishedColumns.hpp), while the writer keeps publishing new versions. 
+ * The chunk columns of the rectangle and around it are read in one version each (the version published when meshing starts).
+ * @param reader Index of the calling reader (must not be reading already)
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const PublishedColumns& columns, uint32_t reader, MeshSink& sink, MeshingContext& context, uint32_t threadCount = 0);
+
+/**
+ * @brief 
+ * Generate an optimized mesh (greedy meshing) for the terrain from paletted chunks (dense terrain with caves and overhangs). 
+ * The mesh will be split in chunks and different face orientations (chunk size of the world of the chunks).
+ * @param chunkStartX x start (in chunks) of the part of the chunks to render
+ * @param chunkStartZ z start (in chunks) of the part of the chunks to render
+ * @param chunkSizeX x size (in chunks) of the part of the chunks to render
+ * @param chunkSizeZ z size (in chunks) of the part of the chunks to render
+ * @param chunks Paletted chunks
+ * @param meshes Vector to add output meshes to
+ * @param squares Vector to add output squares to
+ * @param threadCount Number of threads to use (0: number of hardware threads), the output doesn't depend on it
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const PalettedChunks& chunks, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares, uint32_t threadCount = 0);
+
+/**
+ * @brief Same as above, with the buffers of the mesher kept in a context between calls
+ * @param context Buffers of the mesher (one context can't be used by several calls at the same time)
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const PalettedChunks& chunks, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares, MeshingContext& context, uint32_t threadCount = 0);
+
+/**
+ * @brief Same as above, giving the meshes of each chunk column to a sink (see MeshSink.hpp)
+ * @param sink Destination of the meshes (chunk columns are given in chunk order)
+ * @param occupancy Occupancy of the chunks, to skip chunks without visible faces (nullptr: no summary, up to date with the chunks otherwise)
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const PalettedChunks& chunks, MeshSink& sink, MeshingContext& context, uint32_t threadCount = 0, const OccupancySummary* occupancy = nullptr);
+
+/**
+ * @brief 
+ * Generate an optimized mesh (greedy meshing) for the terrain from a height map. 
+ * Faces are found directly from the height differences between columns, without building solid blocks, 
+ * then merged like for the other formats: the output is the same as for the compact format generated from the same heights.
+ * @param chunkStartX x start (in chunks) of the part of the height map to render
+ * @param chunkStartZ z start (in chunks) of the part of the height map to render
+ * @param chunkSizeX x size (in chunks) of the part of the height map to render
+ * @param chunkSizeZ z size (in chunks) of the part of the height map to render
+ * @param heightMap Height map
+ * @param meshes Vector to add output meshes to
+ * @param squares Vector to add output squares to
+ * @param threadCount Number of threads to use (0: number of hardware threads), the output doesn't depend on it
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const HeightMap& heightMap, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares, uint32_t threadCount = 0);
+
+/**
+ * @brief Same as above, with the buffers of the mesher kept in a context and the meshes given to a sink (see MeshSink.hpp)
+ * @param sink Destination of the meshes (chunk columns are given in chunk order)
+ * @param context Buffers of the mesher (one context can't be used by several calls at the same time)
+**/
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const HeightMap& heightMap, MeshSink& sink, MeshingContext& context, uint32_t threadCount = 0);
+
+/**
+ * @brief Measure the speed of face classification (finding the visible faces of each chunk and their IDs, before greedy meshing) on one thread
+ * @param columns Block columns (all chunks are classified)
+ * @return Speed (in million faces / second)
 **/
-void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, int* IDs, uint32_t* IDIndexes, std::vector<VoxelMesh>& meshes, std::vector<Square>& squares);
+double benchmarkFaceClassification(const CompactColumnsView& columns);
 
 #endif
\ No newline at end of file
@@ -4,11 +4,61 @@
 #include <cstdint>
 #include <vector>
 
+#include "TerrainGenerator.hpp"
+#include "DensityGenerator.hpp"
+#include "CompactColumns.hpp"
+#include "HeightMap.hpp"
+#include "WorldConfig.hpp"
+
 /**
- * @brief Generate a terrain
+ * @brief 
+ * Generate a terrain.
+ * Heights are generated by bands of chunk rows, so temporary memory is proportional to the band size.
+ * The output doesn't depend on the number of threads or on the band size.
+ * @param generator Generator of the height of each (x, z)
+ * @param world Dimensions of the world (heights are clamped to its vertical size)
  * @param IDs Block IDs
- * @param IDIndexes Start index for each (x, z) in IDs
+ * @param IDIndexes Start index for each (x, z) in IDs (world.columnCount() + 1 elements)
+ * @param threadCount Number of threads to use (0: number of hardware threads)
+ * @param bandChunks Number of chunk rows to generate at once (0: whole terrain at once)
+**/
+void generateTerrain(const TerrainGenerator& generator, const WorldConfig& world, std::vector<int>& IDs, uint32_t* IDIndexes, uint32_t threadCount = 0, uint32_t bandChunks = 0);
+
+/**
+ * @brief 
+ * Generate a terrain in the compact format (one stored block per column).
+ * Heights are generated by bands of chunk rows, so temporary memory is proportional to the band size.
+ * The output doesn't depend on the number of threads or on the band size.
+ * @param generator Generator of the height of each (x, z)
+ * @param world Dimensions of the world (heights are clamped to its vertical size)
+ * @param columns Output columns
+ * @param threadCount Number of threads to use (0: number of hardware threads)
+ * @param bandChunks Number of chunk rows to generate at once (0: whole terrain at once)
+**/
+void generateTerrain(const TerrainGenerator& generator, const WorldConfig& world, CompactColumns& columns, uint32_t threadCount = 0, uint32_t bandChunks = 0);
+
+/**
+ * @brief 
+ * Generate a terrain as a height map (same blocks as the compact format, meshed without the column format, see GenerateMesh.hpp).
+ * The output doesn't depend on the number of threads.
+ * @param generator Generator of the height of each (x, z)
+ * @param world Dimensions of the world (heights are clamped to its vertical size)
+ * @param heightMap Output height map
+ * @param threadCount Number of threads to use (0: number of hardware threads)
+**/
+void generateTerrain(const TerrainGenerator& generator, const WorldConfig& world, HeightMap& heightMap, uint32_t threadCount = 0);
+
+/**
+ * @brief 
+ * Generate a 3D terrain (caves and overhangs) in the compact format.
+ * Only blocks next to air are stored, with invisible blocks (ID 0) for the hidden blocks next to them, so the mesher doesn't render faces between them.
+ * Chunks are generated independently, so temporary memory is proportional to the number of threads.
+ * The output doesn't depend on the number of threads.
+ * @param generator Generator of the solid blocks
+ * @param world Dimensions of the world
+ * @param columns Output columns
+ * @param threadCount Number of threads to use (0: number of hardware threads)
 **/
-void generateTerrain(std::vector<int>& IDs, uint32_t* IDIndexes);
+void generateTerrain(const DensityGenerator& generator, const WorldConfig& world, CompactColumns& columns, uint32_t threadCount = 0);
 
-#endif
\ No newline at end of file
+#endif
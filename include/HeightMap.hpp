@@ -0,0 +1,55 @@
+#ifndef HEIGHT_MAP_H
+#define HEIGHT_MAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "WorldConfig.hpp"
+
+// Height field terrain (3 bytes per column): one visible block at the top of each (x, z) column, on invisible blocks.
+// It contains the same blocks as the compact format generated from the same height field (see GenerateTerrain.hpp),
+// where each column has invisible blocks (ID 0) down to the lowest top of the columns around it.
+// Index of (x, z) : x + z * horizontalSize (rows of the world, not chunks)
+
+
+class HeightMap {
+public:
+    WorldConfig world; // Dimensions of the world
+    std::vector<uint16_t> heights; // y of the highest block of each column (at least 1)
+    std::vector<uint8_t> ids; // Color ID of the highest block of each column
+
+    /**
+     * @brief Create an empty height map
+    **/
+    HeightMap() = default;
+
+    /**
+     * @brief Create a height map of a world with all columns at height 1 and ID 0
+     * @param world Dimensions of the world
+    **/
+    explicit HeightMap(const WorldConfig& world);
+
+    /**
+     * @brief Height of a column
+    **/
+    int height(int x, int z) const {
+        return heights[x + z * world.horizontalSize];
+    }
+
+    /**
+     * @brief ID of the highest block of a column
+    **/
+    int id(int x, int z) const {
+        return ids[x + z * world.horizontalSize];
+    }
+
+    /**
+     * @brief Memory used by the height map
+     * @return Size (in bytes)
+    **/
+    size_t memorySize() const;
+};
+
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Files made of a header followed by sections starting at multiples of 4096 bytes (see WorldFile.hpp and MeshCache.hpp).
+// Sections are page aligned, so a mapped file is used directly (no parsing or copy),
+// and processes mapping the same file share its pages through the page cache.
+
+
+class MappedFile {
+public:
+    static constexpr uint64_t alignment = 4096; // Alignment of sections
+
+    /**
+     * @brief Map a whole file read-only (throws if the file can't be mapped or is smaller than minSize)
+     * @param path Path of the file
+     * @param minSize Minimum size of the file (in bytes)
+    **/
+    MappedFile(char const* path, size_t minSize);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) = delete;
+    MappedFile(MappedFile const&) = delete;
+
+    /**
+     * @brief Content of the file, valid while the file is mapped
+    **/
+    const uint8_t* bytes() const {
+        return (const uint8_t*)data;
+    }
+
+    /**
+     * @brief Size of the file (in bytes)
+    **/
+    size_t fileSize() const {
+        return size;
+    }
+
+    /**
+     * @brief Check that a section is aligned and inside the file
+     * @param offset Offset of the section (in bytes)
+     * @param sectionSize Size of the section (in bytes)
+     * @return Whether the section is valid
+    **/
+    bool validSection(uint64_t offset, uint64_t sectionSize) const {
+        return offset % alignment == 0 && offset <= size && sectionSize <= size - offset;
+    }
+
+    /**
+     * @brief Place sections one after the other after a header
+     * @param headerSize Size of the header (in bytes)
+     * @param sectionCount Number of sections
+     * @param sectionSizes Size of each section (in bytes)
+     * @param sectionOffsets Output offset of each section (in bytes)
+    **/
+    static void placeSections(size_t headerSize, int sectionCount, const uint64_t* sectionSizes, uint64_t* sectionOffsets);
+
+    /**
+     * @brief Write a file (written to a temporary file then renamed, so mappings of the old file stay valid)
+     * @param path Path of the file
+     * @param header Header of the file
+     * @param headerSize Size of the header (in bytes)
+     * @param sectionCount Number of sections
+     * @param sections Content of each section
+     * @param sectionSizes Size of each section (in bytes)
+     * @param sectionOffsets Offset of each section (in bytes, see placeSections())
+    **/
+    static void write(char const* path, const void* header, size_t headerSize, int sectionCount, const void* const* sections, const uint64_t* sectionSizes, const uint64_t* sectionOffsets);
+
+private:
+    void* data;
+    size_t size;
+};
+
+
+#endif
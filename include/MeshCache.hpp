@@ -0,0 +1,96 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "VoxelMesh.hpp"
+#include "MappedFile.hpp"
+
+// Mesh cache file (meshes of a world saved as they are uploaded to the GPU, native byte order, see MappedFile.hpp):
+// - header: magic "VXMESH", version, mesher version, hash of the world (see CompactColumnsView::contentHash()), whether the meshes include
+//   the levels of detail, offset and count of each section
+// - sections MeshData, Square, each starting at a multiple of 4096 bytes
+// A mapped file is directly uploaded by the renderer (no meshing and no copy in memory), after checking that every mesh is in the square section.
+// The file is only valid for the world it was generated from, for the current mesher version and with the same levels of detail setting (see GenerateMesh.hpp).
+
+
+class MeshCache {
+public:
+    static constexpr uint32_t version = 3; // Must change when the format changes
+
+    /**
+     * @brief Map a mesh cache file read-only (throws if the file is missing, invalid or generated by another version of the mesher)
+     * @param path Path of the file
+    **/
+    explicit MeshCache(char const* path);
+
+    MeshCache(MeshCache&& other) = delete;
+    MeshCache(MeshCache const&) = delete;
+
+    /**
+     * @brief Hash of the world the meshes were generated from
+    **/
+    uint64_t worldHash() const {
+        return hash;
+    }
+
+    /**
+     * @brief Whether the meshes include the levels of detail of each chunk column (see MeshingContext::levelsOfDetail())
+    **/
+    bool levelsOfDetail() const {
+        return lodMeshes;
+    }
+
+    /**
+     * @brief Information of all meshes, valid while the file is mapped
+    **/
+    const MeshData* meshData() const {
+        return meshes;
+    }
+
+    /**
+     * @brief Number of meshes (including padding meshes)
+    **/
+    uint32_t meshCount() const {
+        return meshesCount;
+    }
+
+    /**
+     * @brief All squares of the meshes, valid while the file is mapped
+    **/
+    const Square* squares() const {
+        return squaresData;
+    }
+
+    /**
+     * @brief Number of squares
+    **/
+    uint32_t squareCount() const {
+        return squaresCount;
+    }
+
+    /**
+     * @brief Save meshes to a mesh cache file (written to a temporary file then renamed, so mappings of the old file stay valid)
+     * @param path Path of the file
+     * @param worldHash Hash of the world the meshes were generated from
+     * @param levelsOfDetail Whether the meshes include the levels of detail
+     * @param meshData Information of all meshes
+     * @param meshCount Number of meshes
+     * @param squares All squares of the meshes
+     * @param squareCount Number of squares
+    **/
+    static void save(char const* path, uint64_t worldHash, bool levelsOfDetail, const MeshData* meshData, uint32_t meshCount, const Square* squares, uint32_t squareCount);
+
+private:
+    MappedFile file;
+    uint64_t hash;
+    bool lodMeshes;
+    const MeshData* meshes;
+    uint32_t meshesCount;
+    const Square* squaresData;
+    uint32_t squaresCount;
+};
+
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef MESH_SINK_H
+#define MESH_SINK_H
+
+#include <cstdint>
+#include <vector>
+
+#include "VoxelMesh.hpp"
+
+// Destination of the meshes generated by generateMesh() (see GenerateMesh.hpp).
+// The meshes of each chunk column are given once, in chunk order, and are only valid during the call,
+// so a sink can write them straight to their final storage (for example renderer-ready arrays, a mapped GPU buffer or a mapped file).
+
+
+class MeshSink {
+public:
+    virtual ~MeshSink() = default;
+
+    /**
+     * @brief Add the meshes of a chunk column (never called by several threads at the same time)
+     * @param chunkX x of the chunk column (in chunks)
+     * @param chunkZ z of the chunk column (in chunks)
+     * @param meshes Meshes of the chunk column
+     * @param meshCount Number of meshes
+     * @param squares Squares of the meshes, one mesh after the other
+     * @param squareCount Number of squares
+    **/
+    virtual void addMeshes(uint32_t chunkX, uint32_t chunkZ, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) = 0;
+};
+
+
+// Write renderer-ready meshes (see TerrainRenderer.hpp) to arrays of a fixed size
+class ArrayMeshSink : public MeshSink {
+public:
+    /**
+     * @brief Create a sink writing to arrays
+     * @param meshData Array for the information of the meshes
+     * @param meshCapacity Size of meshData
+     * @param squares Array for the squares
+     * @param squareCapacity Size of squares
+     * @param startSquare Index in the final squares buffer of squares[0]
+    **/
+    ArrayMeshSink(MeshData* meshData, uint32_t meshCapacity, Square* squares, uint32_t squareCapacity, uint32_t startSquare = 0);
+
+    /**
+     * @brief Add the meshes of a chunk column if they fit in the arrays (see complete())
+    **/
+    void addMeshes(uint32_t chunkX, uint32_t chunkZ, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) override;
+
+    /**
+     * @brief Number of meshes added, including the ones which didn't fit (size needed for meshData)
+    **/
+    uint32_t meshCount() const {
+        return meshes;
+    }
+
+    /**
+     * @brief Number of squares added, including the ones which didn't fit (size needed for squares)
+    **/
+    uint32_t squareCount() const {
+        return squareTotal;
+    }
+
+    /**
+     * @brief Whether all meshes fit in the arrays (after the first chunk column that doesn't fit, nothing is written)
+    **/
+    bool complete() const {
+        return meshes <= meshCapacity && squareTotal <= squareCapacity;
+    }
+
+private:
+    MeshData* meshData;
+    uint32_t meshCapacity;
+    Square* squares;
+    uint32_t squareCapacity;
+    uint32_t startSquare;
+    uint32_t meshes;
+    uint32_t squareTotal;
+};
+
+
+// Add renderer-ready meshes (see TerrainRenderer.hpp) to vectors
+class VectorMeshSink : public MeshSink {
+public:
+    /**
+     * @brief Create a sink adding to vectors
+     * @param meshData Vector to add the information of the meshes to
+     * @param squares Vector to add the squares to (the meshes start after the squares already in it)
+    **/
+    VectorMeshSink(std::vector<MeshData>& meshData, std::vector<Square>& squares);
+
+    void addMeshes(uint32_t chunkX, uint32_t chunkZ, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) override;
+
+    /**
+     * @brief Add meshes of any chunks (the chunks are not needed to add to vectors)
+    **/
+    void addMeshes(const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount);
+
+private:
+    std::vector<MeshData>& meshData;
+    std::vector<Square>& squares;
+};
+
+
+#endif
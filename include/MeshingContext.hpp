@@ -0,0 +1,107 @@
+#ifndef MESHING_CONTEXT_H
+#define MESHING_CONTEXT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "VoxelMesh.hpp"
+
+// Buffers of the mesher (see GenerateMesh.hpp), kept from one call to the next so that meshing regions or edits doesn't allocate memory,
+// and whether the mesher generates the levels of detail of the chunk columns.
+// Buffers only grow (to the largest size used so far). Buffers of at least hugePageSize bytes are anonymous mappings,
+// which can be backed by transparent huge pages (fewer TLB misses on the face planes).
+
+
+enum class MeshingBuffer {
+    containedIDs,
+    minY,
+    maxY,
+    idToIndex,
+    indexToId,
+    rows,
+    sides,
+    chunkIDs,
+    planes,
+    touchedPlanes,
+    chunkOutputs,
+    pinnedChunks,
+    lodCells,
+    lodRows,
+    lodPlaneIDs,
+    lodPlaneRows,
+    count // Number of buffers
+};
+
+
+class MeshingContext {
+public:
+    static constexpr size_t hugePageSize = 2 << 20; // Size of a transparent huge page
+
+    /**
+     * @brief Create a context without buffers (they are allocated when first used)
+     * @param hugePages Whether to ask for transparent huge pages for large buffers
+     * @param levelsOfDetail Whether to generate the downsampled meshes of each chunk column (false: only full resolution meshes,
+     * much faster meshing and fewer squares, see README.md)
+    **/
+    explicit MeshingContext(bool hugePages = true, bool levelsOfDetail = true);
+
+    ~MeshingContext();
+
+    MeshingContext(MeshingContext&& other) = delete;
+    MeshingContext(MeshingContext const&) = delete;
+
+    /**
+     * @brief Get a buffer, growing it if it is too small (its content is lost when it grows, new buffers are filled with zeros)
+     * @param buffer Buffer to get
+     * @param count Minimum number of elements
+     * @return The buffer, valid until it is requested with a larger size or the context is released
+    **/
+    template<typename T> T* get(MeshingBuffer buffer, size_t count) {
+        return (T*)bytes(buffer, count * sizeof(T));
+    }
+
+    /**
+     * @brief Whether meshes generated with this context include the downsampled levels of detail
+    **/
+    bool levelsOfDetail() const {
+        return lodMeshes;
+    }
+
+    /**
+     * @brief Output vectors of each thread (empty, their capacity is kept from previous calls)
+     * @param threadCount Number of threads
+     * @return threadCount vectors
+    **/
+    std::vector<VoxelMesh>* threadMeshes(uint32_t threadCount);
+
+    /**
+     * @brief Same as threadMeshes() for squares
+    **/
+    std::vector<Square>* threadSquares(uint32_t threadCount);
+
+    /**
+     * @brief Free all buffers (the context can still be used)
+    **/
+    void release();
+
+    /**
+     * @brief Memory used by the buffers
+     * @return Size (in bytes)
+    **/
+    size_t memorySize() const;
+
+private:
+    bool hugePages;
+    bool lodMeshes;
+    void* buffers[(int)MeshingBuffer::count];
+    size_t sizes[(int)MeshingBuffer::count];
+    std::vector<std::vector<VoxelMesh>> meshes;
+    std::vector<std::vector<Square>> squares;
+
+    void* bytes(MeshingBuffer buffer, size_t size);
+    void freeBuffer(int buffer);
+};
+
+
+#endif
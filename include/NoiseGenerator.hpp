@@ -0,0 +1,44 @@
+#ifndef NOISE_GENERATOR_H
+#define NOISE_GENERATOR_H
+
+#include <cstdint>
+
+#include "TerrainGenerator.hpp"
+
+
+// Multi-octave value noise (fBm), evaluated for 8 columns at once with AVX2 (4 with SSE4.1, 1 without SIMD)
+class NoiseGenerator : public TerrainGenerator {
+public:
+    /**
+     * @brief Create a new noise generator
+     * @param seed Random seed
+     * @param octaves Number of noise octaves
+     * @param period Size (in blocks) of the largest features
+    **/
+    explicit NoiseGenerator(uint32_t seed = 0, int octaves = 6, float period = 1024);
+
+    void generate(int startX, int z, int count, int* heights, int* ids) const override;
+
+    /**
+     * @brief ID of the highest block of a column
+     * @param height Height of the column
+    **/
+    static int blockID(int height);
+
+private:
+    uint32_t seed;
+    int octaves;
+    float frequency;
+
+    /**
+     * @brief Generate heights and IDs for exactly the SIMD width of columns
+     * @param startX x of the first column
+     * @param z z of the row
+     * @param heights Output heights
+     * @param ids Output block IDs
+    **/
+    void generateLanes(int startX, int z, int* heights, int* ids) const;
+};
+
+
+#endif
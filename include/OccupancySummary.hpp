@@ -0,0 +1,110 @@
+#ifndef OCCUPANCY_SUMMARY_H
+#define OCCUPANCY_SUMMARY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "CompactColumns.hpp"
+#include "PalettedChunks.hpp"
+#include "WorldConfig.hpp"
+
+// Coarse occupancy of the blocks of a world, for code that can skip parts of the world without looking at blocks
+// (the mesher skips chunks without visible faces, picking and culling can skip empty parts).
+// Each chunk is split in 4^3 sub-blocks (16^3 blocks for 64^3 chunks, 8^3 blocks for 32^3 chunks), with one bit per sub-block in 64 bits masks.
+// Index of chunk (chunkX, chunkY, chunkZ) : chunkY + (chunkX + chunkZ * horizontalChunks) * verticalChunks (same as PalettedChunks)
+// Bit of sub-block (x, y, z) in its chunk : x + y * 4 + z * 16
+// Columns outside the world are solid and blocks above and below the world are air, like for the mesher.
+// The summary must be updated when blocks change (see update()).
+
+
+enum class Occupancy {
+    empty, // No block
+    full, // Only solid blocks
+    mixed // Solid blocks and air
+};
+
+
+class OccupancySummary {
+public:
+    static constexpr int subBlocks = 4; // Number of sub-blocks of a chunk on each axis
+
+    WorldConfig world; // Dimensions of the summarized world
+    std::vector<uint64_t> occupied; // Sub-blocks containing at least one solid block
+    std::vector<uint64_t> full; // Sub-blocks containing only solid blocks
+
+    /**
+     * @brief Create an empty summary
+    **/
+    OccupancySummary() = default;
+
+    /**
+     * @brief Summarize columns in the compact format (invisible blocks are solid)
+     * @param columns Block columns
+     * @param threadCount Number of threads to use (0: number of hardware threads)
+    **/
+    explicit OccupancySummary(const CompactColumnsView& columns, uint32_t threadCount = 0);
+
+    /**
+     * @brief Summarize paletted chunks
+     * @param chunks Paletted chunks
+     * @param threadCount Number of threads to use (0: number of hardware threads)
+    **/
+    explicit OccupancySummary(const PalettedChunks& chunks, uint32_t threadCount = 0);
+
+    /**
+     * @brief Summarize a chunk column again after its blocks changed
+     * @param chunkX x of the chunk column (in chunks)
+     * @param chunkZ z of the chunk column (in chunks)
+     * @param columns Block columns (in the same world)
+    **/
+    void update(uint32_t chunkX, uint32_t chunkZ, const CompactColumnsView& columns);
+
+    /**
+     * @brief Summarize a chunk again after its blocks changed
+     * @param chunkX x of the chunk (in chunks)
+     * @param chunkY y of the chunk (in chunks)
+     * @param chunkZ z of the chunk (in chunks)
+     * @param chunks Paletted chunks (in the same world)
+    **/
+    void update(uint32_t chunkX, uint32_t chunkY, uint32_t chunkZ, const PalettedChunks& chunks);
+
+    /**
+     * @brief Occupancy of a whole chunk
+    **/
+    Occupancy occupancy(uint32_t chunkX, uint32_t chunkY, uint32_t chunkZ) const {
+        uint32_t chunk = chunkY + (chunkX + chunkZ * world.horizontalChunks) * world.verticalChunks;
+        if (occupied[chunk] == 0) return Occupancy::empty;
+        if (full[chunk] == ~(uint64_t)0) return Occupancy::full;
+        return Occupancy::mixed;
+    }
+
+    /**
+     * @brief Check if a block can be solid (false if its sub-block is empty)
+     * @param x x of the block
+     * @param y y of the block
+     * @param z z of the block
+    **/
+    bool maybeSolid(int x, int y, int z) const;
+
+    /**
+     * @brief Check if blocks of a chunk column can have visible faces (false if all their sub-blocks are empty or surrounded by full sub-blocks)
+     * @param chunkX x of the chunk column (in chunks)
+     * @param chunkZ z of the chunk column (in chunks)
+     * @param startY First y of the blocks
+     * @param endY Last y of the blocks (excluded)
+    **/
+    bool canHaveFaces(uint32_t chunkX, uint32_t chunkZ, int startY, int endY) const;
+
+    /**
+     * @brief Memory used by the summary
+     * @return Size (in bytes)
+    **/
+    size_t memorySize() const;
+
+private:
+    bool fullSubBlock(int x, int y, int z) const;
+};
+
+
+#endif
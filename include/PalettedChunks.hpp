@@ -0,0 +1,107 @@
+#ifndef PALETTED_CHUNKS_H
+#define PALETTED_CHUNKS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "CompactColumns.hpp"
+#include "WorldConfig.hpp"
+
+// Dense storage of blocks by chunks of chunkSize^3 blocks.
+// Each chunk has a palette of the block IDs it contains and stores a palette index for each block, with 0, 1, 2, 4 or 8 bits per block.
+// Palette index 0 is always air (no block).
+// Indices are stored by x rows: row (y, z) starts at bit (y + z * chunkSize) * chunkSize * bits, block x is at bit x * bits of the row.
+
+
+class PalettedChunk {
+public:
+    static constexpr int16_t air = -1;
+
+    std::vector<int16_t> palette; // Block ID of each palette index
+    uint32_t size; // Size of the chunk on each axis
+    uint32_t bits; // Bits per block
+    std::vector<uint64_t> data; // Palette index of each block
+
+    /**
+     * @brief Create an empty chunk
+     * @param size Size of the chunk on each axis (32 or 64)
+    **/
+    explicit PalettedChunk(uint32_t size = 64);
+
+    /**
+     * @brief Create a chunk from all its blocks
+     * @param size Size of the chunk on each axis (32 or 64)
+     * @param blocks Block ID of each block (air for no block), index of (x, y, z) : x + y * size + z * size^2
+    **/
+    PalettedChunk(uint32_t size, const int16_t* blocks);
+
+    /**
+     * @brief Get the block ID of a block
+     * @return Block ID (air for no block)
+    **/
+    int16_t getID(uint32_t x, uint32_t y, uint32_t z) const {
+        if (bits == 0) return air;
+        uint32_t bit = ((y + z * size) * size + x) * bits;
+        return palette[(data[bit / 64] >> (bit % 64)) & ((1 << bits) - 1)];
+    }
+
+    /**
+     * @brief Get the solid blocks of an x row
+     * @return Bit x is 1 if block (x, y, z) is not air
+    **/
+    uint64_t solidRow(uint32_t y, uint32_t z) const;
+
+    /**
+     * @brief Check if the chunk doesn't contain any block
+    **/
+    bool empty() const {
+        return bits == 0;
+    }
+
+    /**
+     * @brief Memory used by the chunk
+     * @return Size (in bytes)
+    **/
+    size_t memorySize() const;
+};
+
+
+class PalettedChunks {
+public:
+    WorldConfig world; // Dimensions of the world the chunks are in
+    std::vector<PalettedChunk> chunks; // Index of chunk (chunkX, chunkY, chunkZ) : chunkY + (chunkX + chunkZ * horizontalChunks) * verticalChunks
+
+    /**
+     * @brief Convert blocks from the IDs format (see GenerateMesh.hpp)
+     * @param world Dimensions of the world
+     * @param IDs Block IDs
+     * @param IDIndexes Start index for each (x, z) in IDs
+     * @param threadCount Number of threads to use (0: number of hardware threads)
+    **/
+    PalettedChunks(const WorldConfig& world, const int* IDs, const uint32_t* IDIndexes, uint32_t threadCount = 0);
+
+    /**
+     * @brief Convert blocks from the compact format (in the same world)
+     * @param columns Block columns
+     * @param threadCount Number of threads to use (0: number of hardware threads)
+    **/
+    explicit PalettedChunks(const CompactColumns& columns, uint32_t threadCount = 0);
+
+    /**
+     * @brief Get a chunk
+     * @return The chunk at (chunkX, chunkY, chunkZ)
+    **/
+    const PalettedChunk& chunk(uint32_t chunkX, uint32_t chunkY, uint32_t chunkZ) const {
+        return chunks[chunkY + (chunkX + chunkZ * world.horizontalChunks) * world.verticalChunks];
+    }
+
+    /**
+     * @brief Memory used by the chunks
+     * @return Size (in bytes)
+    **/
+    size_t memorySize() const;
+};
+
+
+#endif
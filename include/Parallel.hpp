@@ -0,0 +1,23 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Number of threads to use when 0 is given to parallelFor()
+ * @return Number of hardware threads (at least 1)
+**/
+uint32_t defaultThreadCount();
+
+/**
+ * @brief 
+ * Run a function for each index in [0, count) using multiple threads.
+ * Indices are distributed dynamically, so the order of the calls is not specified.
+ * @param count Number of indices
+ * @param threadCount Number of threads to use (0: number of hardware threads)
+ * @param function Function to run for each index, also receives the index of the thread running it (in [0, threadCount))
+**/
+void parallelFor(uint32_t count, uint32_t threadCount, const std::function<void(uint32_t index, uint32_t thread)>& function);
+
+#endif
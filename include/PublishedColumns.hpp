@@ -0,0 +1,124 @@
+#ifndef PUBLISHED_COLUMNS_H
+#define PUBLISHED_COLUMNS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "CompactColumns.hpp"
+#include "ChunkedColumns.hpp"
+#include "WorldConfig.hpp"
+
+// Chunk columns published by one writer thread to reader threads (for example meshing threads while edits are applied), without locks.
+// The writer publishes versions of columns stored by chunk columns (see ChunkedColumns.hpp): each chunk column that changed
+// since the last publication is replaced by one atomic pointer store. Published chunk columns are shared with the writer's columns,
+// so they are never modified (the writer's next edits copy them).
+// Replaced chunk columns are released with epochs: a reader marks the epoch it starts reading in, chunk columns replaced
+// in an epoch are released once every reader has stopped reading or started reading in a later epoch.
+// A reader sees each chunk column in one version, chunk columns read at different times can be from different versions.
+
+
+class PublishedColumns {
+public:
+    WorldConfig world; // Dimensions of the world the columns are in
+
+    /**
+     * @brief Publish a first version of columns
+     * @param columns Block columns
+     * @param readerCount Number of reader threads (each reader has its own index, from 0 to readerCount - 1)
+    **/
+    PublishedColumns(const ChunkedColumns& columns, uint32_t readerCount);
+
+    PublishedColumns(PublishedColumns&& other) = delete;
+    PublishedColumns(PublishedColumns const&) = delete;
+
+    /**
+     * @brief Writer: publish a new version of the columns (only its changed chunk columns are replaced), then release what no reader uses anymore
+     * @param columns Block columns (same world)
+     * @return Number of chunk columns replaced
+    **/
+    uint32_t publish(const ChunkedColumns& columns);
+
+    /**
+     * @brief Writer: release the replaced chunk columns that no reader can still use
+    **/
+    void reclaim();
+
+    /**
+     * @brief Writer: number of replaced chunk columns not released yet
+    **/
+    size_t retiredCount() const {
+        return retired.size();
+    }
+
+    /**
+     * @brief Reader: start reading, the chunk columns read until endRead() stay valid (a reader can't start reading again before endRead())
+     * @param reader Index of the reader
+    **/
+    void beginRead(uint32_t reader) const {
+        readers[reader].epoch.store(epoch.load());
+    }
+
+    /**
+     * @brief Reader: get the published version of a chunk column (between beginRead() and endRead())
+     * @param chunk Index of the chunk column (chunkX + chunkZ * horizontalChunks)
+     * @return Columns of a world of one chunk column
+    **/
+    const CompactColumns& chunk(uint32_t chunk) const {
+        return *chunks[chunk].load();
+    }
+
+    /**
+     * @brief Reader: stop reading (chunk columns read since beginRead() can then be released)
+     * @param reader Index of the reader
+    **/
+    void endRead(uint32_t reader) const {
+        readers[reader].epoch.store(notReading);
+    }
+
+private:
+    static constexpr uint64_t notReading = UINT64_MAX;
+
+    // Epoch a reader started reading in (on its own cache line, readers don't write to each other's line)
+    struct alignas(64) ReaderEpoch {
+        std::atomic<uint64_t> epoch { notReading };
+    };
+
+    // Chunk column replaced in an epoch
+    struct RetiredChunk {
+        uint64_t epoch;
+        std::shared_ptr<const CompactColumns> columns;
+    };
+
+    std::unique_ptr<std::atomic<const CompactColumns*>[]> chunks; // Published version of each chunk column (read by readers)
+    std::vector<std::shared_ptr<const CompactColumns>> current; // Published version of each chunk column (kept alive by the writer)
+    std::vector<RetiredChunk> retired; // Replaced chunk columns, by epoch
+    std::unique_ptr<ReaderEpoch[]> readers;
+    uint32_t readerCount;
+    std::atomic<uint64_t> epoch; // Incremented by each publication
+};
+
+
+// Reader: read published columns for the lifetime of the object (endRead() is called by the destructor, also when an exception is thrown)
+class PublishedRead {
+public:
+    PublishedRead(const PublishedColumns& columns, uint32_t reader) : columns(columns), reader(reader) {
+        columns.beginRead(reader);
+    }
+
+    ~PublishedRead() {
+        columns.endRead(reader);
+    }
+
+    PublishedRead(PublishedRead&& other) = delete;
+    PublishedRead(PublishedRead const&) = delete;
+
+private:
+    const PublishedColumns& columns;
+    uint32_t reader;
+};
+
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef SIMD_NOISE_H
+#define SIMD_NOISE_H
+
+#include <cstdint>
+#include <cmath>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// SIMD helpers for value noise, shared by the noise generators (NoiseGenerator.cpp, DensityGenerator.cpp).
+// Only included by source files: each one gets the widest instruction set it is compiled with.
+
+
+// Same operations for each instruction set, the noise is written once with them
+#if defined(__AVX2__)
+static constexpr int lanes = 8;
+typedef __m256 Floats;
+typedef __m256i Ints;
+static inline Floats floats(float value) { return _mm256_set1_ps(value); }
+static inline Ints ints(uint32_t value) { return _mm256_set1_epi32(value); }
+static inline Ints laneIndices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+static inline Floats add(Floats a, Floats b) { return _mm256_add_ps(a, b); }
+static inline Floats sub(Floats a, Floats b) { return _mm256_sub_ps(a, b); }
+static inline Floats mul(Floats a, Floats b) { return _mm256_mul_ps(a, b); }
+static inline Floats roundDown(Floats a) { return _mm256_floor_ps(a); }
+static inline Floats toFloats(Ints a) { return _mm256_cvtepi32_ps(a); }
+static inline Ints toInts(Floats a) { return _mm256_cvttps_epi32(a); }
+static inline Ints add(Ints a, Ints b) { return _mm256_add_epi32(a, b); }
+static inline Ints mul(Ints a, Ints b) { return _mm256_mullo_epi32(a, b); }
+static inline Ints bitXor(Ints a, Ints b) { return _mm256_xor_si256(a, b); }
+template<int shift> static inline Ints shiftRight(Ints a) { return _mm256_srli_epi32(a, shift); }
+static inline Ints load(const int* input) { return _mm256_loadu_si256((const __m256i*)input); }
+static inline void store(int* output, Ints a) { _mm256_storeu_si256((__m256i*)output, a); }
+static inline void store(float* output, Floats a) { _mm256_storeu_ps(output, a); }
+static inline int lessThan(Floats a, Floats b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); } // Bit i: lane i
+#elif defined(__SSE4_1__)
+static constexpr int lanes = 4;
+typedef __m128 Floats;
+typedef __m128i Ints;
+static inline Floats floats(float value) { return _mm_set1_ps(value); }
+static inline Ints ints(uint32_t value) { return _mm_set1_epi32(value); }
+static inline Ints laneIndices() { return _mm_setr_epi32(0, 1, 2, 3); }
+static inline Floats add(Floats a, Floats b) { return _mm_add_ps(a, b); }
+static inline Floats sub(Floats a, Floats b) { return _mm_sub_ps(a, b); }
+static inline Floats mul(Floats a, Floats b) { return _mm_mul_ps(a, b); }
+static inline Floats roundDown(Floats a) { return _mm_floor_ps(a); }
+static inline Floats toFloats(Ints a) { return _mm_cvtepi32_ps(a); }
+static inline Ints toInts(Floats a) { return _mm_cvttps_epi32(a); }
+static inline Ints add(Ints a, Ints b) { return _mm_add_epi32(a, b); }
+static inline Ints mul(Ints a, Ints b) { return _mm_mullo_epi32(a, b); }
+static inline Ints bitXor(Ints a, Ints b) { return _mm_xor_si128(a, b); }
+template<int shift> static inline Ints shiftRight(Ints a) { return _mm_srli_epi32(a, shift); }
+static inline Ints load(const int* input) { return _mm_loadu_si128((const __m128i*)input); }
+static inline void store(int* output, Ints a) { _mm_storeu_si128((__m128i*)output, a); }
+static inline void store(float* output, Floats a) { _mm_storeu_ps(output, a); }
+static inline int lessThan(Floats a, Floats b) { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+#else
+static constexpr int lanes = 1;
+typedef float Floats;
+typedef uint32_t Ints;
+static inline Floats floats(float value) { return value; }
+static inline Ints ints(uint32_t value) { return value; }
+static inline Ints laneIndices() { return 0; }
+static inline Floats add(Floats a, Floats b) { return a + b; }
+static inline Floats sub(Floats a, Floats b) { return a - b; }
+static inline Floats mul(Floats a, Floats b) { return a * b; }
+static inline Floats roundDown(Floats a) { return std::floor(a); }
+static inline Floats toFloats(Ints a) { return (float)(int32_t)a; }
+static inline Ints toInts(Floats a) { return (uint32_t)(int32_t)a; }
+static inline Ints add(Ints a, Ints b) { return a + b; }
+static inline Ints mul(Ints a, Ints b) { return a * b; }
+static inline Ints bitXor(Ints a, Ints b) { return a ^ b; }
+template<int shift> static inline Ints shiftRight(Ints a) { return a >> shift; }
+static inline Ints load(const int* input) { return (uint32_t)*input; }
+static inline void store(int* output, Ints a) { *output = (int32_t)a; }
+static inline void store(float* output, Floats a) { *output = a; }
+static inline int lessThan(Floats a, Floats b) { return a < b; }
+#endif
+
+
+// Random value in [0, 1) for each lattice point
+static inline Floats latticeHash(Ints x, Ints z, Ints seed) {
+    Ints h = add(add(mul(x, ints(0x8da6b343)), mul(z, ints(0xd8163841))), seed);
+    h = mul(bitXor(h, shiftRight<16>(h)), ints(0x7feb352d));
+    h = mul(bitXor(h, shiftRight<15>(h)), ints(0x846ca68b));
+    h = bitXor(h, shiftRight<16>(h));
+    return mul(toFloats(shiftRight<8>(h)), floats(1.0f / (1 << 24)));
+}
+
+
+// Smoothstep interpolation weight
+static inline Floats fade(Floats t) {
+    return mul(mul(t, t), sub(floats(3), add(t, t)));
+}
+
+
+static inline Floats interpolate(Floats a, Floats b, Floats t) {
+    return add(a, mul(sub(b, a), t));
+}
+
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef SINE_GENERATOR_H
+#define SINE_GENERATOR_H
+
+#include "TerrainGenerator.hpp"
+
+
+// Smooth hills: product of a sine in x and a sine in z
+class SineGenerator : public TerrainGenerator {
+public:
+    void generate(int startX, int z, int count, int* heights, int* ids) const override;
+};
+
+
+#endif
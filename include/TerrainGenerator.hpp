@@ -0,0 +1,29 @@
+#ifndef TERRAIN_GENERATOR_H
+#define TERRAIN_GENERATOR_H
+
+
+// Height field generator used by generateTerrain()
+class TerrainGenerator {
+public:
+    virtual ~TerrainGenerator() = default;
+
+    /**
+     * @brief Generate the height and block ID of consecutive columns in a row
+     * @param startX x of the first column
+     * @param z z of the row
+     * @param count Number of columns
+     * @param heights Output heights (y of the highest block, at least 1, clamped to the world height by generateTerrain())
+     * @param ids Output block IDs (of the highest block)
+    **/
+    virtual void generate(int startX, int z, int count, int* heights, int* ids) const = 0;
+
+    /**
+     * @brief Measure the generation speed on one thread
+     * @param size Size (in columns) of the square area to generate
+     * @return Generation speed (in millions of columns per second)
+    **/
+    double benchmark(int size) const;
+};
+
+
+#endif
@@ -1,11 +1,37 @@
 #ifndef TERRAIN_RENDERER_H
 #define TERRAIN_RENDERER_H
 
+#include <cstdint>
 #include <vector>
 
 #include "GLObjects/OpenGL.hpp"
 #include "Camera.hpp"
 #include "VoxelMesh.hpp"
+#include "MeshSink.hpp"
+#include "WorldConfig.hpp"
+
+class TerrainRenderer;
+
+
+// Meshes of a chunk column in the buffers of the renderer
+struct ChunkMeshes {
+    uint32_t meshStart;
+    uint32_t meshCapacity; // Mesh slots of the chunk column (unused slots are empty meshes)
+    uint32_t squareStart;
+    uint32_t squareCapacity;
+};
+
+
+// Replace the meshes of the chunk columns it is given in a renderer (see TerrainRenderer::updateSink())
+class RendererUpdateSink : public MeshSink {
+public:
+    explicit RendererUpdateSink(TerrainRenderer& renderer);
+
+    void addMeshes(uint32_t chunkX, uint32_t chunkZ, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) override;
+
+private:
+    TerrainRenderer& renderer;
+};
 
 
 class TerrainRenderer {
@@ -13,8 +39,10 @@ public:
     /**
      * @brief Create a new voxel terrain renderer
      * @param camera Camera to use to render the terrain
+     * @param world Dimensions of the world of the meshes
+     * @param levelsOfDetail Whether the meshes include the levels of detail (false: every chunk column is drawn at full resolution)
     **/
-    explicit TerrainRenderer(Camera& camera);
+    TerrainRenderer(Camera& camera, const WorldConfig& world, bool levelsOfDetail = true);
 
     /**
      * @brief Add meshes to render (before starting to render)
@@ -23,6 +51,13 @@ public:
     **/
     void addMeshes(const std::vector<VoxelMesh>& meshes, const std::vector<Square>& squares);
 
+    /**
+     * @brief Sink adding meshes to render, to generate meshes directly in the renderer (same as addMeshes() without the copy)
+    **/
+    MeshSink& meshSink() {
+        return sink;
+    }
+
     /**
      * @brief 
      * Prepare for render.
@@ -30,6 +65,52 @@ public:
     **/
     void prepareRender();
 
+    /**
+     * @brief 
+     * Prepare for render from meshes already prepared by prepareRender() (for example mapped from a mesh cache, see MeshCache.hpp).
+     * The data is uploaded directly, without copies. Replaces meshes added with addMeshes().
+     * @param meshData Information of all meshes (count must be a multiple of the work group size)
+     * @param meshCount Number of meshes
+     * @param squares All squares of the meshes
+     * @param squareCount Number of squares
+    **/
+    void prepareRender(const MeshData* meshData, uint32_t meshCount, const Square* squares, uint32_t squareCount);
+
+    /**
+     * @brief
+     * Replace the meshes of a chunk column (after prepareRender()). Only the data of the chunk column is uploaded:
+     * it is written over its old meshes if they have room for it, or after the meshes of all chunk columns otherwise
+     * (with room to grow, the buffers grow when they are full).
+     * @param chunkX x of the chunk column (in chunks)
+     * @param chunkZ z of the chunk column (in chunks)
+     * @param meshes New meshes of the chunk column
+     * @param meshCount Number of meshes
+     * @param squares Squares of the meshes, one mesh after the other
+     * @param squareCount Number of squares
+    **/
+    void replaceMeshes(uint32_t chunkX, uint32_t chunkZ, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount);
+
+    /**
+     * @brief Sink replacing the meshes of the chunk columns it is given (see replaceMeshes()), to mesh edited chunks directly in the renderer
+    **/
+    MeshSink& updateSink() {
+        return update;
+    }
+
+    /**
+     * @brief Information of all meshes added with addMeshes() (ready to upload after prepareRender())
+    **/
+    const std::vector<MeshData>& allMeshData() const {
+        return meshData;
+    }
+
+    /**
+     * @brief Squares of all meshes added with addMeshes()
+    **/
+    const std::vector<Square>& allSquares() const {
+        return squares;
+    }
+
     /**
      * @brief Render the terrain
     **/
@@ -37,9 +118,14 @@ public:
 
 private:
     Camera& camera;
+    WorldConfig world;
     gl::GraphicsShader shader;
     std::vector<MeshData> meshData; // All meshes information (position, size, rectangles indices)
     std::vector<Square> squares; // All rectangles (position, width, height, normal)
+    VectorMeshSink sink; // Adds to meshData and squares
+    RendererUpdateSink update;
+    std::vector<ChunkMeshes> chunkMeshes; // Meshes of each chunk column in the buffers (index: chunkX + chunkZ * horizontalChunks)
+    std::vector<MeshData> updatedMeshes; // Meshes of the chunk column being replaced
     gl::Buffer squaresBuffer;
     gl::Buffer commandsBuffer;
     gl::VertexArray vertexArray;
@@ -55,7 +141,15 @@ private:
     gl::Uniform rightPlaneUniform;
     gl::Uniform upPlaneUniform;
     gl::Uniform downPlaneUniform;
+    uint32_t meshCount; // Mesh slots processed by the compute shader (multiple of the work group size)
+    uint32_t meshEnd; // Mesh slots used
+    uint32_t meshCapacity;
+    uint32_t squareCount; // Squares used
+    uint32_t squareCapacity;
     uint32_t workGroups;
+
+    void findChunkMeshes(const MeshData* meshData, uint32_t meshCount);
+    void reserve(uint32_t meshes, uint32_t squares);
 };
 
 
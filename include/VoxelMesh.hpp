@@ -50,23 +50,25 @@ constexpr int normalSign(CubeNormal normal) {
 
 class Square {
 public:
-    Square(uint32_t x, uint32_t y, uint32_t z, uint32_t w, uint32_t h, CubeNormal normal, uint32_t colorID) :
-        data1(x | (z << 13)),
-        data2(y | ((w - 1) << 9) | ((h - 1) << 15) | ((uint32_t)normal << 21) | (colorID << 24)) {}
+    Square(uint32_t x, uint32_t y, uint32_t z, uint32_t w, uint32_t h, CubeNormal normal, uint32_t colorID, uint32_t lod = 0) :
+        data1(x | (z << 13) | (lod << 26) | ((y >> 9) << 28)),
+        data2((y & 511) | ((w - 1) << 9) | ((h - 1) << 15) | ((uint32_t)normal << 21) | (colorID << 24)) {}
 
 private:
-    uint32_t data1; // x (13b), z (13b)
-    uint32_t data2; // y (9b), width (6b), height (6b), normal (3b), color (8b)
+    uint32_t data1; // x (13b), z (13b), lod (2b), y / 512 (1b)
+    uint32_t data2; // y % 512 (9b), width (6b), height (6b), normal (3b), color (8b), width and height in cells of 2^lod blocks
 };
 
 
 
-// Mesh with all rectangles with the same normal and in the same chunk
+// Mesh with all rectangles with the same normal and in the same chunk.
+// Meshes of a level of detail (lod) above 0 are meshes of the chunk downsampled to cells of 2^lod blocks on each axis.
 class VoxelMesh {
 public:
     glm::u32vec3 position;
     CubeNormal normal;
     uint32_t squaresCount;
+    uint32_t lod;
 
     /**
      * @brief Create a new voxel mesh
@@ -74,20 +76,41 @@ public:
      * @param chunkX x index of the chunk the mesh is in
      * @param chunkZ z index of the chunk the mesh is in
      * @param startY y index of the chunk the mesh is in
+     * @param chunkSize Size of a chunk
+     * @param lod Level of detail (rectangles are in cells of 2^lod blocks)
     **/
-    VoxelMesh(CubeNormal normal, int chunkX, int chunkZ, int startY);
+    VoxelMesh(CubeNormal normal, int chunkX, int chunkZ, int startY, int chunkSize, uint32_t lod = 0);
 
     /**
      * @brief Add a new rectangle to the mesh
-     * @param x x start index of the rectangle in the plane
-     * @param y y start index of the rectangle in the plane
-     * @param depth Index of the plane
-     * @param width Width of the rectangle
-     * @param height Height of the rectangle
+     * @tparam meshNormal Normal of the mesh (known at compile time so that the axes of the rectangle are too)
+     * @param x x start index of the rectangle in the plane (in cells)
+     * @param y y start index of the rectangle in the plane (in cells)
+     * @param depth Index of the plane (in cells)
+     * @param width Width of the rectangle (in cells)
+     * @param height Height of the rectangle (in cells)
      * @param colorID Color ID of the rectangle
      * @return The square that was added (must be stored in a seperate container)
     **/
-    Square add(int x, int y, int depth, int width, int height, int colorID);
+    template<CubeNormal meshNormal> Square add(int x, int y, int depth, int width, int height, int colorID) {
+        constexpr uint32_t depthAxis = axis(meshNormal);
+        squaresCount++;
+        glm::u32vec3 min;
+        min[widthAxis(depthAxis)] = x << lod;
+        min[heightAxis(depthAxis)] = y << lod;
+        min[depthAxis] = depth << lod;
+        glm::u32vec3 max = min;
+        max[widthAxis(depthAxis)] += width << lod;
+        max[heightAxis(depthAxis)] += height << lod;
+        if (min.x < minX) minX = min.x;
+        if (min.y < minY) minY = min.y;
+        if (min.z < minZ) minZ = min.z;
+        if (max.x > maxX) maxX = max.x;
+        if (max.y > maxY) maxY = max.y;
+        if (max.z > maxZ) maxZ = max.z;
+        glm::u32vec3 pos = min + position;
+        return Square(pos.x, pos.y, pos.z, width, height, meshNormal, colorID, lod);
+    }
 
     glm::vec3 center() const {
         return (glm::vec3)position + glm::vec3(minX + maxX, minY + maxY, minZ + maxZ) / 2.0f;
@@ -110,16 +133,16 @@ private:
 
 class MeshData {
 public:
-    MeshData(glm::vec3 center, glm::vec3 size, CubeNormal normal, uint32_t squareCount, uint32_t startSquare) :
+    MeshData(glm::vec3 center, glm::vec3 size, CubeNormal normal, uint32_t squareCount, uint32_t startSquare, uint32_t lod = 0) :
         center(center),
-        data1((uint32_t)normal | (squareCount << 3)),
+        data1((uint32_t)normal | (lod << 3) | (squareCount << 5)),
         size(size),
         data2(startSquare) {}
-    MeshData(const VoxelMesh& mesh, uint32_t startSquare) : MeshData(mesh.center(), mesh.size(), mesh.normal, mesh.squaresCount, startSquare) {};
+    MeshData(const VoxelMesh& mesh, uint32_t startSquare) : MeshData(mesh.center(), mesh.size(), mesh.normal, mesh.squaresCount, startSquare, mesh.lod) {};
 
 public:
     glm::vec3 center;
-    uint32_t data1; // normal (3b), squareCount (29b)
+    uint32_t data1; // normal (3b), lod (2b), squareCount (27b)
     glm::vec3 size;
     uint32_t data2; // startSquare (32b)
 };
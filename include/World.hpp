@@ -0,0 +1,229 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <glm/glm.hpp>
+
+#include "CompactColumns.hpp"
+#include "ChunkedColumns.hpp"
+#include "MeshSink.hpp"
+#include "MeshingContext.hpp"
+#include "WorldConfig.hpp"
+
+// Editable world in the compact format, stored by chunk columns (see ChunkedColumns.hpp).
+// Edits update the columns in place, in the same form as generated columns (same content hash for the same blocks once merged),
+// and mark the chunk columns whose meshes changed (the chunk column of the edited block, and its neighbours when the block is on their border).
+// Each edit (one block or a brush of many blocks) rewrites each changed column once, then moves the blocks of each edited chunk column in one pass.
+// Snapshots share the chunk columns with the world: an edit only copies the shared chunk columns it changes.
+// remesh() then only meshes these chunk columns, for example into the renderer (see TerrainRenderer::updateSink()).
+// Blocks hidden inside the terrain are not stored by the compact format: unstored blocks directly above an invisible block (ID 0),
+// or below the lowest block of a column when it is invisible, are solid, the other unstored blocks are air.
+// Edits keep solid blocks next to air stored with a visible ID and solid blocks next to visible blocks stored, so that the terrain stays closed:
+// blocks exposed by removed blocks get the ID of a removed block next to them (or the ID given by the world's ExposedBlockID at their height).
+
+
+// ID of a hidden block exposed by an edit when no removed block next to it has a visible ID (for example DensityGenerator::blockID())
+// y: y of the block, covered: whether the block above is solid
+typedef std::function<int(int y, bool covered)> ExposedBlockID;
+
+
+// Blocks from start to end (included) of a column replaced by a brush
+struct ColumnFill {
+    int start;
+    int end;
+    int id; // Color ID, or World::air
+};
+
+
+// Column expanded by an edit, with one block per y (see World::edit())
+struct ExpandedColumn {
+    uint8_t changes; // Whether the blocks with faces or the stored hidden blocks of the column changed
+    int removedStart; // Range of y of the blocks removed by the edit (empty if start >= end)
+    int removedEnd;
+    int revealedStart; // Range of y of the blocks that became visible in the edit
+    int revealedEnd;
+};
+
+
+// Columns expanded by an edit: the edited rectangle and the columns around it (end excluded)
+struct EditWindow {
+    int startX;
+    int startZ;
+    int endX;
+    int endZ;
+};
+
+
+// Column rewritten by an edit (before its blocks are moved to the columns)
+struct EditedColumn {
+    uint32_t chunk; // Index of the chunk column
+    uint32_t xzIndex; // Index of the column in its chunk column
+    uint32_t start; // First stored block in the blocks of the edited columns
+    uint32_t count; // Number of stored blocks
+    uint16_t bottom;
+    uint32_t oldStart; // Blocks of the column before the edit
+    uint32_t oldEnd;
+};
+
+
+class World {
+public:
+    static constexpr int air = -1; // ID returned by block() for air
+
+    /**
+     * @brief Create an editable world from columns (copied)
+     * @param columns Block columns (for example mapped from a world file, see WorldFile.hpp)
+     * @param exposedBlockID IDs of the hidden blocks exposed by edits (usually the ones of the generator of the columns)
+    **/
+    World(const CompactColumnsView& columns, ExposedBlockID exposedBlockID);
+
+    /**
+     * @brief Create an editable world from columns stored by chunk columns (shared with the world until they are edited)
+     * @param columns Block columns (for example a snapshot of another world)
+     * @param exposedBlockID IDs of the hidden blocks exposed by edits (usually the ones of the generator of the columns)
+    **/
+    World(const ChunkedColumns& columns, ExposedBlockID exposedBlockID);
+
+    World(World&& other) = delete;
+    World(World const&) = delete;
+
+    /**
+     * @brief Dimensions of the world
+    **/
+    const WorldConfig& config() const {
+        return blocks.world;
+    }
+
+    /**
+     * @brief Columns of the world (updated by each edit)
+    **/
+    const ChunkedColumns& columns() const {
+        return blocks;
+    }
+
+    /**
+     * @brief Take a snapshot of the world (copies one pointer per chunk column, edited chunk columns are copied by the next edits)
+     * @return Columns of the world, not changed by the next edits
+    **/
+    ChunkedColumns snapshot() const {
+        return blocks;
+    }
+
+    /**
+     * @brief Go back to a snapshot (for example to undo edits), the chunk columns that changed since then are marked as edited
+     * @param snapshot Snapshot of the world (see snapshot())
+    **/
+    void restore(const ChunkedColumns& snapshot);
+
+    /**
+     * @brief ID of a block
+     * @return Color ID of the block (0: invisible block, including blocks hidden inside the terrain), or air
+    **/
+    int block(int x, int y, int z) const;
+
+    /**
+     * @brief Replace a block (throws a runtime_error if the block is outside of the world)
+     * @param x x of the block
+     * @param y y of the block
+     * @param z z of the block
+     * @param id Color ID of the new block (1 to 255, invisible blocks could leave holes in the terrain)
+    **/
+    void setBlock(int x, int y, int z, int id);
+
+    /**
+     * @brief Replace a block with air (throws a runtime_error if the block is outside of the world)
+     * @param x x of the block
+     * @param y y of the block
+     * @param z z of the block
+    **/
+    void removeBlock(int x, int y, int z);
+
+    /**
+     * @brief Fill a box with blocks or air (blocks outside of the world are ignored)
+     * @param min Lowest corner of the box
+     * @param max Highest corner of the box (included)
+     * @param id Color ID of the blocks (1 to 255), or air
+    **/
+    void fillBox(glm::ivec3 min, glm::ivec3 max, int id);
+
+    /**
+     * @brief Fill a sphere with blocks or air (blocks outside of the world are ignored)
+     * @param center Block at the center of the sphere
+     * @param radius Radius of the sphere (blocks at most radius blocks away from the center are filled)
+     * @param id Color ID of the blocks (1 to 255), or air
+    **/
+    void fillSphere(glm::ivec3 center, int radius, int id);
+
+    /**
+     * @brief
+     * Set the height of the columns of a rectangle, for example to stamp a height field on the terrain (columns outside of the world are ignored).
+     * Blocks above the height of a column become air, blocks from its height down to just above its lowest neighbour column
+     * become id (so that the sides of the columns are closed) and blocks below don't change.
+     * @param startX x of the first column
+     * @param startZ z of the first column
+     * @param sizeX Number of columns on x
+     * @param sizeZ Number of columns on z
+     * @param heights y of the highest block of each column (index: x + z * sizeX, from 0 to verticalSize - 1)
+     * @param id Color ID of the blocks (1 to 255)
+    **/
+    void stampHeights(int startX, int startZ, int sizeX, int sizeZ, const int* heights, int id);
+
+    /**
+     * @brief Find the first solid block on a ray
+     * @param origin Start of the ray
+     * @param direction Direction of the ray (normalized)
+     * @param maxDistance Length of the ray
+     * @param hit Output: coordinates of the block
+     * @param before Output: coordinates of the block on the ray before it (where a block placed against it goes)
+     * @return Whether a block was found
+    **/
+    bool raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, glm::ivec3& hit, glm::ivec3& before) const;
+
+    /**
+     * @brief Chunk columns edited since the last call to remesh() (index: chunkX + chunkZ * horizontalChunks)
+    **/
+    const std::vector<uint32_t>& dirtyChunks() const {
+        return dirty;
+    }
+
+    /**
+     * @brief Mesh the edited chunk columns on one thread (same meshes as meshing the whole world, see GenerateMesh.hpp)
+     * @param sink Destination of the meshes of each edited chunk column
+     * @param context Buffers of the mesher
+    **/
+    void remesh(MeshSink& sink, MeshingContext& context);
+
+private:
+    ChunkedColumns blocks;
+    ExposedBlockID exposedBlockID;
+    std::vector<bool> dirtyFlags; // Whether each chunk column is already in dirty
+    std::vector<uint32_t> dirty; // Edited chunk columns (index: chunkX + chunkZ * horizontalChunks)
+    std::vector<ExpandedColumn> windowColumns; // Rows of columns expanded by the current edit (see edit())
+    std::vector<int16_t> windowBlocks; // Blocks of the expanded columns: color ID, air or hidden (verticalSize per column)
+    std::vector<uint8_t> windowFlags; // Changes of each block of the expanded columns in the current edit
+    std::vector<uint8_t> windowIDs; // ID of each removed block of the expanded columns before the edit
+    std::vector<uint16_t> columnYs; // Stored blocks of the rewritten column
+    std::vector<uint8_t> columnIDs;
+    std::vector<EditedColumn> edited; // Columns rewritten by the current edit
+    std::vector<uint16_t> editedYs; // Stored blocks of the rewritten columns
+    std::vector<uint8_t> editedIDs;
+
+    uint32_t chunkIndex(int x, int z) const;
+    uint32_t columnIndex(int x, int z) const;
+    int columnTop(int x, int z) const;
+    template<typename Brush> void edit(int startX, int startZ, int endX, int endZ, const Brush& brush);
+    uint32_t windowColumn(const EditWindow& window, int x, int z) const;
+    void expandColumn(const EditWindow& window, int x, int z, const ColumnFill* fills, int fillCount);
+    void exposeRow(const EditWindow& window, int z);
+    void coverRow(const EditWindow& window, int z);
+    void storeRow(const EditWindow& window, int z);
+    void storeColumn(uint32_t chunk, uint32_t xzIndex);
+    void applyEdits();
+    void markDirty(int x, int z);
+    void markDirty(uint32_t chunk);
+};
+
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef WORLD_CONFIG_H
+#define WORLD_CONFIG_H
+
+#include <cstdint>
+
+// Dimensions of a world (in blocks), chosen at runtime.
+// Squares store x and z on 13 bits and y on 10 bits, which limits horizontalSize to 8192 and verticalSize to 512
+// (faces on top of the highest blocks are at y = verticalSize).
+
+
+class WorldConfig {
+public:
+    int horizontalSize; // x and z size
+    int verticalSize; // y size
+    int chunkSize; // Size of a chunk on each axis (32 or 64)
+    int horizontalChunks; // Number of chunks on x and z
+    int verticalChunks; // Number of chunks on y
+
+    /**
+     * @brief Create a world configuration (throws if the dimensions are not supported)
+     * @param horizontalSize x and z size (multiple of chunkSize, at most 8192)
+     * @param verticalSize y size (multiple of chunkSize, at most 512)
+     * @param chunkSize Size of a chunk (32 or 64)
+    **/
+    explicit WorldConfig(int horizontalSize = 4096, int verticalSize = 512, int chunkSize = 64);
+
+    /**
+     * @brief Number of (x, z) columns in the world
+    **/
+    uint32_t columnCount() const {
+        return (uint32_t)horizontalSize * horizontalSize;
+    }
+
+    bool operator==(const WorldConfig& other) const {
+        return horizontalSize == other.horizontalSize && verticalSize == other.verticalSize && chunkSize == other.chunkSize;
+    }
+};
+
+
+#endif
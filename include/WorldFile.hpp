@@ -0,0 +1,66 @@
+#ifndef WORLD_FILE_H
+#define WORLD_FILE_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "CompactColumns.hpp"
+#include "MappedFile.hpp"
+
+// World file (compact columns saved as they are in memory, native byte order, see MappedFile.hpp):
+// - header: magic "VXWORLD", version, world dimensions, generator ID, content hash (see CompactColumnsView::contentHash()), offset and size (in bytes) of each section
+// - sections ys, ids, bottoms, index.rowStarts, index.offsets, each starting at a multiple of 4096 bytes
+// A mapped file is used directly by the mesher (no parsing or copy), after checking that the index and the ys stay in the sections and the world.
+
+
+class WorldFile {
+public:
+    static constexpr uint32_t version = 3; // Must change when the format changes
+
+    /**
+     * @brief Map a world file read-only (throws if the file is missing or invalid)
+     * @param path Path of the file
+    **/
+    explicit WorldFile(char const* path);
+
+    WorldFile(WorldFile&& other) = delete;
+    WorldFile(WorldFile const&) = delete;
+
+    /**
+     * @brief Columns of the world, valid while the file is mapped
+    **/
+    const CompactColumnsView& columns() const {
+        return view;
+    }
+
+    /**
+     * @brief Hash of the columns, computed when the file was saved (no need to read the whole file)
+    **/
+    uint64_t contentHash() const {
+        return hash;
+    }
+
+    /**
+     * @brief Identifier of the generator of the world, given when the file was saved (see DensityGenerator::id())
+    **/
+    uint64_t generatorID() const {
+        return generator;
+    }
+
+    /**
+     * @brief Save columns to a world file (written to a temporary file then renamed, so mappings of the old file stay valid)
+     * @param path Path of the file
+     * @param columns Columns to save
+     * @param generatorID Identifier of the generator of the columns (0: unknown)
+    **/
+    static void save(char const* path, const CompactColumns& columns, uint64_t generatorID);
+
+private:
+    MappedFile file;
+    CompactColumnsView view;
+    uint64_t hash;
+    uint64_t generator;
+};
+
+
+#endif
@@ -5,7 +5,7 @@ layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
 
 struct MeshData {
 	vec3 center;
-	uint data1; // normal (3b), squaresCount (29b)
+	uint data1; // normal (3b), lod (2b), squaresCount (27b)
 	vec3 size;
 	uint data2; // startSquare (32b)
 };
@@ -17,7 +17,9 @@ struct IndirectDrawArgs {
     uint baseInstance;
 };
 
+#define mask2Bits 3u // 0b11
 #define mask3Bits 7u // 0b111
+#define lodCount 3u // Number of downsampled levels of detail (see GenerateMesh.hpp)
 
 
 // Inputs
@@ -27,6 +29,8 @@ uniform vec4 rightPlane;
 uniform vec4 upPlane;
 uniform vec4 downPlane;
 uniform vec3 position;
+uniform float chunkSize;
+uniform float lodDistance; // Distance of the first downsampled level of detail, each next level starts twice as far
 layout(binding = 0, std430) readonly restrict buffer meshDataBuffer { MeshData meshData[]; }; // All meshes information (position, size, squares indices)
 
 // Outputs
@@ -57,14 +61,30 @@ bool cameraCulling(vec3 center, vec3 size, vec3 normal) {
 }
 
 
+// Level of detail of the chunk column containing a corner of a mesh (from the horizontal distance to the chunk column)
+uint chunkLod(vec3 corner) {
+	vec2 chunkStart = floor(corner.xz / chunkSize) * chunkSize;
+	vec2 outside = max(max(chunkStart - position.xz, position.xz - chunkStart - chunkSize), 0.0);
+	float chunkDistance = length(outside);
+	if (chunkDistance < lodDistance) return 0;
+	return min(lodCount, uint(floor(log2(chunkDistance / lodDistance))) + 1);
+}
+
+
 void main() {
 	MeshData mesh = meshData[gl_GlobalInvocationID.x];
 	uint normalID = mesh.data1 & mask3Bits;
-	uint squaresCount = mesh.data1 >> 3;
+	uint lod = (mesh.data1 >> 3) & mask2Bits;
+	uint squaresCount = mesh.data1 >> 5;
 	uint startSquare = mesh.data2;
     vec3 normal = vec3(0, 0, 0);
     normal[normalID >> 1] = -2 * float(normalID & 1u) + 1;
 
+	// Only draw the meshes of the level of detail of their chunk column (meshes with a positive normal start one cell after their chunk)
+	vec3 corner = mesh.center - mesh.size;
+	corner[normalID >> 1] -= float((~normalID & 1u) << lod);
+	if (lod != chunkLod(corner)) return;
+
 	if (cameraCulling(mesh.center, mesh.size, normal)) {
 		uint commandIndex = atomicCounterIncrement(commandsCount);
 		commands[commandIndex].instanceCount = squaresCount;
@@ -31,7 +31,7 @@ const vec4 colors[5] = {
 };
 
 
-layout(location = 0) in uvec2 square; // x: x (13b), z (13b) ; y: y (9b), width (6b), height (6b), normal (3b), color (8b)
+layout(location = 0) in uvec2 square; // x: x (13b), z (13b), lod (2b), y / 512 (1b) ; y: y % 512 (9b), width (6b), height (6b), normal (3b), color (8b)
 
 uniform mat4 vpMatrix;
 uniform vec3 position;
@@ -40,10 +40,11 @@ uniform float quadsInterleaving; // Size increase to remove small (1 pixel) gaps
 
 void main() {
     // Unpack data
-    vec3 cubePos = vec3(square.x & mask13Bits, square.y & mask9Bits, square.x >> 13);
+    vec3 cubePos = vec3(square.x & mask13Bits, (square.y & mask9Bits) | (((square.x >> 28) & 1u) << 9), (square.x >> 13) & mask13Bits);
     uint normalID = (square.y >> 21) & mask3Bits;
-    float width = ((square.y >> 9) & mask6Bits) + 1;
-    float height = ((square.y >> 15) & mask6Bits) + 1;
+    float cellSize = float(1u << ((square.x >> 26) & mask2Bits)); // Width and height are in cells of the level of detail
+    float width = (((square.y >> 9) & mask6Bits) + 1) * cellSize;
+    float height = (((square.y >> 15) & mask6Bits) + 1) * cellSize;
     uint normalAxis = normalID >> 1;
 
     // Position
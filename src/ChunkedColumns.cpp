@@ -0,0 +1,68 @@
+#include "ChunkedColumns.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "CompactColumns.hpp"
+#include "WorldConfig.hpp"
+#include "Parallel.hpp"
+
+using namespace std;
+
+
+// Columns of a chunk column keep their order, rows start at the start of the chunk column
+ChunkedColumns::ChunkedColumns(const CompactColumnsView& columns, uint32_t threadCount) :
+    world(columns.world),
+    chunks(world.horizontalChunks * world.horizontalChunks) {
+    uint32_t chunkColumns = world.chunkSize * world.chunkSize;
+    parallelFor(chunks.size(), threadCount, [&](uint32_t chunk, uint32_t) {
+        shared_ptr<CompactColumns> blocks = make_shared<CompactColumns>();
+        blocks->world = WorldConfig(world.chunkSize, world.verticalSize, world.chunkSize);
+        uint32_t start = columns.index.chunkStart(chunk);
+        uint32_t end = columns.index.chunkStart(chunk + 1);
+        blocks->ys.assign(columns.ys + start, columns.ys + end);
+        blocks->ids.assign(columns.ids + start, columns.ids + end);
+        blocks->bottoms.assign(columns.bottoms + chunk * chunkColumns, columns.bottoms + (chunk + 1) * chunkColumns);
+        blocks->index = ColumnIndex(1, world.chunkSize);
+        for (int row = 0; row <= world.chunkSize; row++) blocks->index.rowStarts[row] = columns.index.rowStarts[chunk * world.chunkSize + row] - start;
+        copy(columns.index.offsets + chunk * chunkColumns, columns.index.offsets + (chunk + 1) * chunkColumns, blocks->index.offsets.begin());
+        chunks[chunk] = move(blocks);
+    });
+}
+
+
+CompactColumns& ChunkedColumns::writeChunk(uint32_t chunk) {
+    if (chunks[chunk].use_count() > 1) chunks[chunk] = make_shared<CompactColumns>(*chunks[chunk]);
+    return *chunks[chunk];
+}
+
+
+CompactColumns ChunkedColumns::merge() const {
+    uint32_t chunkColumns = world.chunkSize * world.chunkSize;
+    CompactColumns columns;
+    columns.world = world;
+    columns.bottoms.resize(world.columnCount());
+    columns.index = ColumnIndex(chunks.size(), world.chunkSize);
+    for (uint32_t chunk = 0; chunk < chunks.size(); chunk++) {
+        const CompactColumns& blocks = *chunks[chunk];
+        uint32_t start = columns.ys.size();
+        columns.ys.insert(columns.ys.end(), blocks.ys.begin(), blocks.ys.end());
+        columns.ids.insert(columns.ids.end(), blocks.ids.begin(), blocks.ids.end());
+        copy(blocks.bottoms.begin(), blocks.bottoms.end(), columns.bottoms.begin() + chunk * chunkColumns);
+        for (int row = 0; row < world.chunkSize; row++) columns.index.rowStarts[chunk * world.chunkSize + row] = blocks.index.rowStarts[row] + start;
+        copy(blocks.index.offsets.begin(), blocks.index.offsets.end(), columns.index.offsets.begin() + chunk * chunkColumns);
+    }
+    columns.index.setEnd(columns.ys.size());
+    return columns;
+}
+
+
+size_t ChunkedColumns::memorySize() const {
+    size_t size = chunks.size() * sizeof(shared_ptr<CompactColumns>);
+    for (const shared_ptr<CompactColumns>& blocks : chunks) size += sizeof(CompactColumns) + blocks->memorySize();
+    return size;
+}
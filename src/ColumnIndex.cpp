@@ -0,0 +1,14 @@
+#include "ColumnIndex.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std;
+
+
+void ColumnIndex::setStart(uint32_t xzIndex, uint32_t start) {
+    if ((xzIndex & ((1 << rowShift) - 1)) == 0) rowStarts[xzIndex >> rowShift] = start;
+    uint32_t offset = start - rowStarts[xzIndex >> rowShift];
+    if (offset > UINT16_MAX) throw runtime_error("Too many blocks in a row of columns for the column index");
+    offsets[xzIndex] = offset;
+}
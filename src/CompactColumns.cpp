@@ -0,0 +1,90 @@
+#include "CompactColumns.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#include "ColumnIndex.hpp"
+#include "WorldConfig.hpp"
+
+using namespace std;
+
+static constexpr uint64_t hashMultiplier1 = 0x9E3779B97F4A7C15;
+static constexpr uint64_t hashMultiplier2 = 0xC2B2AE3D27D4EB4F;
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size);
+uint64_t hashWord(uint64_t hash, uint64_t word);
+
+
+CompactColumns::CompactColumns(const WorldConfig& world, const int* IDs, const uint32_t* IDIndexes) :
+    world(world),
+    bottoms(world.columnCount()),
+    index(world.horizontalChunks * world.horizontalChunks, world.chunkSize) {
+    for (uint32_t column = 0; column < world.columnCount(); column++) {
+        index.setStart(column, ys.size());
+        uint32_t i = IDIndexes[column];
+        uint32_t end = IDIndexes[column + 1];
+        if (i == end) continue;
+
+        // Invisible blocks directly below the next block are not stored
+        bottoms[column] = IDs[i];
+        while (i + 2 < end && IDs[i + 1] == 0 && IDs[i + 2] == IDs[i] + 1) i += 2;
+
+        for (; i < end; i += 2) {
+            ys.push_back(IDs[i]);
+            ids.push_back(IDs[i + 1]);
+        }
+    }
+    index.setEnd(ys.size());
+}
+
+
+uint64_t CompactColumnsView::contentHash() const {
+    uint32_t rowCount = world.horizontalChunks * world.horizontalChunks * world.chunkSize;
+    uint32_t blockCount = index.rowStarts[rowCount];
+    uint64_t hash = hashWord(0, world.horizontalSize);
+    hash = hashWord(hash, world.verticalSize);
+    hash = hashWord(hash, world.chunkSize);
+    hash = hashBytes(hash, ys, blockCount * sizeof(uint16_t));
+    hash = hashBytes(hash, ids, blockCount * sizeof(uint8_t));
+    hash = hashBytes(hash, bottoms, world.columnCount() * sizeof(uint16_t));
+    hash = hashBytes(hash, index.rowStarts, (rowCount + 1) * sizeof(uint32_t));
+    return hashBytes(hash, index.offsets, world.columnCount() * sizeof(uint16_t));
+}
+
+
+size_t CompactColumns::memorySize() const {
+    return ys.size() * sizeof(uint16_t) + ids.size() * sizeof(uint8_t) + bottoms.size() * sizeof(uint16_t) + index.memorySize();
+}
+
+
+// Hash 8 bytes at a time, with 4 independent lanes so the multiplications are not all dependent on each other
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t lanes[4] = { hash, hash + 1, hash + 2, hash + 3 };
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            memcpy(&word, bytes + i + 8 * lane, sizeof(word));
+            lanes[lane] = hashWord(lanes[lane], word);
+        }
+    }
+    for (; i < size; i += 8) {
+        uint64_t word = 0;
+        memcpy(&word, bytes + i, min<size_t>(size - i, sizeof(word)));
+        lanes[0] = hashWord(lanes[0], word);
+    }
+    hash = hashWord(size, lanes[0]);
+    for (int lane = 1; lane < 4; lane++) hash = hashWord(hash, lanes[lane]);
+    return hash;
+}
+
+
+uint64_t hashWord(uint64_t hash, uint64_t word) {
+    hash ^= word * hashMultiplier1;
+    hash = (hash << 31) | (hash >> 33);
+    return hash * hashMultiplier2;
+}
@@ -0,0 +1,228 @@
+#include "DensityGenerator.hpp"
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+#include "NoiseGenerator.hpp"
+#include "SimdNoise.hpp"
+
+using namespace std;
+using namespace chrono;
+
+
+static constexpr int bedrockHeight = 4; // All blocks below are solid (no holes at the bottom of the world)
+static constexpr int overhangAmplitude = 12; // Maximum vertical move of the surface (in blocks)
+static constexpr float overhangFrequency = 1 / 48.0f;
+static constexpr int overhangOctaves = 2;
+static constexpr int cavePeriod = 32; // Size of the cells of the cave noise (power of 2, so the cells are exact y intervals)
+static constexpr float caveThreshold = 0.15f; // Blocks with a lower cave noise are air
+static constexpr float boundMargin = 1e-5f; // Rounding errors of the interpolation, for the bounds of the cave noise
+static constexpr int stoneID = 3; // ID of covered blocks (cave walls and ceilings)
+static constexpr float persistence = 0.5f; // Amplitude ratio between two octaves
+static constexpr uint32_t octaveSeedStep = 0x9e3779b9;
+static constexpr uint32_t latticeYStep = 0x1b873593;
+static constexpr uint32_t overhangSeed = 0x68e31da4;
+static constexpr uint32_t caveSeed = 0xb5297a4d;
+static constexpr int allLanes = (1 << lanes) - 1;
+
+void setBlocks(uint64_t* column, int startY, int endY);
+void addBlocks(uint64_t* solid, int wordCount, int y, int laneMask);
+
+
+// Seed of a horizontal layer of the 3D lattice
+static inline Ints layerSeed(uint32_t seed, int cellY) {
+    return ints(seed + (uint32_t)cellY * latticeYStep);
+}
+
+
+// Value noise of a horizontal layer of the 3D lattice at (x, z) (in lattice units, z is the same for all lanes)
+static inline Floats layerNoise(Floats x, int cellY, float z, uint32_t seed) {
+    Floats cellX = roundDown(x);
+    float cellZ = floor(z);
+    Floats weightX = fade(sub(x, cellX));
+    Floats weightZ = fade(floats(z - cellZ));
+    Ints latticeX = toInts(cellX);
+    Ints nextX = add(latticeX, ints(1));
+    Ints latticeZ = ints((int32_t)cellZ);
+    Ints nextZ = add(latticeZ, ints(1));
+    Ints seedY = layerSeed(seed, cellY);
+    Floats before = interpolate(latticeHash(latticeX, latticeZ, seedY), latticeHash(nextX, latticeZ, seedY), weightX);
+    Floats after = interpolate(latticeHash(latticeX, nextZ, seedY), latticeHash(nextX, nextZ, seedY), weightX);
+    return interpolate(before, after, weightZ);
+}
+
+
+// 3D value noise in [0, 1) along the columns of the lanes.
+// Inside a lattice cell, the noise is an interpolation along y between the bottom and top layers of the cell, so they are only computed once per cell.
+class NoiseColumn {
+public:
+    NoiseColumn() = default;
+
+    NoiseColumn(Floats x, float z, uint32_t seed, float frequency) :
+        x(mul(x, floats(frequency))),
+        z(z * frequency),
+        seed(seed),
+        frequency(frequency),
+        cellY(INT32_MIN),
+        bottom(floats(0)),
+        top(floats(0)) {}
+
+    // Noise at y (in blocks)
+    Floats at(int y) {
+        float positionY = y * frequency;
+        int cell = (int)floor(positionY);
+        if (cell != cellY) {
+            bottom = cell == cellY + 1 ? top : layerNoise(x, cell, z, seed);
+            top = layerNoise(x, cell + 1, z, seed);
+            cellY = cell;
+        }
+        return interpolate(bottom, top, fade(floats(positionY - cell)));
+    }
+
+private:
+    Floats x;
+    float z;
+    uint32_t seed;
+    float frequency;
+    int cellY;
+    Floats bottom;
+    Floats top;
+};
+
+
+
+DensityGenerator::DensityGenerator(uint32_t seed, bool skipIntervals) :
+    surface(seed),
+    seed(seed),
+    skipIntervals(skipIntervals) {
+}
+
+
+void DensityGenerator::generate(int startX, int z, int count, int verticalSize, uint64_t* solid) const {
+    int words = wordCount(verticalSize);
+    int paddedCount = (count + lanes - 1) / lanes * lanes;
+    int* heights = new int[paddedCount];
+    int* ids = new int[paddedCount];
+    uint64_t* lastSolid = new uint64_t[lanes * words];
+    surface.generate(startX, z, paddedCount, heights, ids);
+    fill(solid, solid + count * words, 0);
+    for (int i = 0; i < count; i += lanes) {
+        if (i + lanes <= count) generateLanes(startX + i, z, heights + i, verticalSize, solid + i * words);
+        else { // Last columns (don't fill a whole SIMD register)
+            fill(lastSolid, lastSolid + lanes * words, 0);
+            generateLanes(startX + i, z, heights + i, verticalSize, lastSolid);
+            copy(lastSolid, lastSolid + (count - i) * words, solid + i * words);
+        }
+    }
+    delete[] heights;
+    delete[] ids;
+    delete[] lastSolid;
+}
+
+
+void DensityGenerator::generateLanes(int startX, int z, const int* heights, int verticalSize, uint64_t* solid) const {
+    int words = wordCount(verticalSize);
+    Floats x = toFloats(add(ints(startX), laneIndices()));
+    Floats surfaceHeights = toFloats(load(heights));
+    NoiseColumn caves(x, z, seed ^ caveSeed, 1.0f / cavePeriod);
+
+    // Below solidEnd, all blocks are below the moved surface (only caves remain). From airStart, all blocks are above it.
+    int solidEnd = 0;
+    int airStart = verticalSize;
+    if (skipIntervals) {
+        solidEnd = clamp(*min_element(heights, heights + lanes) - overhangAmplitude, 0, verticalSize);
+        airStart = clamp(*max_element(heights, heights + lanes) + overhangAmplitude, solidEnd, verticalSize);
+    }
+
+    // Solid intervals, one cell of the cave noise at a time
+    for (int y = 0; y < solidEnd;) {
+        int endY = min(solidEnd, y < bedrockHeight ? bedrockHeight : (y / cavePeriod + 1) * cavePeriod);
+        if (y < bedrockHeight || caveFree(startX, y / cavePeriod, z)) {
+            for (int lane = 0; lane < lanes; lane++) setBlocks(solid + lane * words, y, endY);
+            y = endY;
+        }
+        for (; y < endY; y++) addBlocks(solid, words, y, allLanes & ~lessThan(caves.at(y), floats(caveThreshold)));
+    }
+
+    // Evaluate everything around the surface
+    NoiseColumn overhangs[overhangOctaves];
+    float frequency = overhangFrequency;
+    for (int octave = 0; octave < overhangOctaves; octave++) {
+        overhangs[octave] = NoiseColumn(x, z, seed ^ (overhangSeed + octave * octaveSeedStep), frequency);
+        frequency *= 2;
+    }
+    for (int y = solidEnd; y < airStart; y++) {
+        if (y < bedrockHeight) {
+            addBlocks(solid, words, y, allLanes);
+            continue;
+        }
+        Floats overhang = floats(0);
+        float amplitude = 1;
+        float totalAmplitude = 0;
+        for (int octave = 0; octave < overhangOctaves; octave++) {
+            overhang = add(overhang, mul(overhangs[octave].at(y), floats(amplitude)));
+            totalAmplitude += amplitude;
+            amplitude *= persistence;
+        }
+        overhang = sub(mul(overhang, floats(2 / totalAmplitude)), floats(1)); // In [-1, 1)
+        int blocks = lessThan(floats(y), add(surfaceHeights, mul(overhang, floats(overhangAmplitude))));
+        if (blocks != 0) blocks &= ~lessThan(caves.at(y), floats(caveThreshold));
+        addBlocks(solid, words, y, blocks);
+    }
+}
+
+
+// The cave noise in a cell is an interpolation of the values at the corners of the cell, so it is at least the smallest of them
+bool DensityGenerator::caveFree(int startX, int cellY, int z) const {
+    int firstCellX = (int)floor((float)startX / cavePeriod);
+    int lastCellX = (int)floor((float)(startX + lanes - 1) / cavePeriod) + 1;
+    int cellZ = (int)floor((float)z / cavePeriod);
+    float values[lanes];
+    for (int y = cellY; y <= cellY + 1; y++) {
+        for (int latticeZ = cellZ; latticeZ <= cellZ + 1; latticeZ++) {
+            for (int latticeX = firstCellX; latticeX <= lastCellX; latticeX += lanes) {
+                store(values, latticeHash(add(ints(latticeX), laneIndices()), ints(latticeZ), layerSeed(seed ^ caveSeed, y)));
+                for (int i = 0; i < lanes && latticeX + i <= lastCellX; i++) {
+                    if (values[i] < caveThreshold + boundMargin) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+
+int DensityGenerator::blockID(int y, bool covered) {
+    return covered ? stoneID : NoiseGenerator::blockID(y);
+}
+
+
+double DensityGenerator::benchmark(int size, int verticalSize) const {
+    uint64_t* solid = new uint64_t[size * wordCount(verticalSize)];
+    steady_clock::time_point start = steady_clock::now();
+    for (int z = 0; z < size; z++) generate(0, z, size, verticalSize, solid);
+    double seconds = duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1e9;
+    delete[] solid;
+    return (double)size * size * verticalSize / seconds / 1e6;
+}
+
+
+// Set blocks from startY to endY (excluded) of a column
+void setBlocks(uint64_t* column, int startY, int endY) {
+    for (int y = startY; y < endY;) {
+        int end = min(endY, (y / 64 + 1) * 64);
+        uint64_t bits = end - y == 64 ? ~(uint64_t)0 : (((uint64_t)1 << (end - y)) - 1) << (y % 64);
+        column[y / 64] |= bits;
+        y = end;
+    }
+}
+
+
+// Set block y of the columns of the lanes in laneMask
+void addBlocks(uint64_t* solid, int wordCount, int y, int laneMask) {
+    for (; laneMask != 0; laneMask &= laneMask - 1) {
+        solid[__builtin_ctz(laneMask) * wordCount + y / 64] |= (uint64_t)1 << (y % 64);
+    }
+}
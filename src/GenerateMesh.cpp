@@ -3,54 +3,284 @@
 #include <vector>
 #include <cstdint>
 #include <cmath>
+#include <type_traits>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
 #include <glm/glm.hpp>
 
 #include "VoxelMesh.hpp"
-#include "Constants.hpp"
+#include "Parallel.hpp"
+#include "MeshingContext.hpp"
+#include "MeshSink.hpp"
+#include "CompactColumns.hpp"
+#include "ChunkedColumns.hpp"
+#include "PublishedColumns.hpp"
+#include "PalettedChunks.hpp"
+#include "HeightMap.hpp"
+#include "OccupancySummary.hpp"
+#include "WorldConfig.hpp"
 
 using namespace std;
 using namespace glm;
+using namespace chrono;
 
-void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, int* IDs, uint32_t* IDIndexes, uint64_t* rows, bvec2* sides);
-void generateXZSides(uint32_t xzIndex, bool after, int startIndex, int startY, int* IDs, uint32_t* IDIndexes, bvec2* sides);
-void generateXZSides(bool after, int startIndex, bvec2* sides);
-void generateBinaryPlanes(uint32_t startXZIndex, int startY, int* IDs, uint32_t* IDIndexes, uint64_t* rows, bvec2* sides, uint64_t* planes, int* idToIndex, int idCount);
-void generateAxisBinaryPlanes(uint32_t axis, uint32_t startXZIndex, int startY, int* IDs, uint32_t* IDIndexes, uint64_t* rows, bvec2* sides, uint64_t* planes, int* idToIndex, int idCount);
-int getID(ivec3 pos, int startXZIndex, int* IDs, uint32_t* IDIndexes);
-void generateOptimizedMesh(uint32_t chunkX, uint32_t chunkZ, int startY, uint64_t* planes, int* indexToId, int idCount, vector<VoxelMesh>& meshes, vector<Square>& squares);
-void generateNormalOptimizedMesh(CubeNormal normal, uint32_t chunkX, uint32_t chunkZ, int startY, uint64_t* planes, int* indexToId, int idCount, vector<VoxelMesh>& meshes, vector<Square>& squares);
-void generateOptimizedPlane(CubeNormal normal, int depth, int idIndex, VoxelMesh& mesh, uint64_t* planes, int* indexToId, int idCount, vector<Square>& squares);
+// The mesher is instantiated for each chunk size, so that loops on rows have constant bounds like with a fixed chunk size.
+// A row of blocks of a chunk is one integer: bit i is block i of the row.
+template<int chunkSize> using ChunkRow = typename conditional<chunkSize == 64, uint64_t, uint32_t>::type;
 
+static constexpr int transposeMinBlocks = 24000; // Solid blocks of a 64^3 chunk from which rows are transposed instead of built block by block (scaled by chunkSize^2)
 
-void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, int* IDs, uint32_t* IDIndexes, vector<VoxelMesh>& meshes, vector<Square>& squares) {
-    // Find IDs in area and y range for each (x, z) chunk
-    bool* containedIDs = new bool[256] { false };
-    int idCount = 0;
-    int* minY = new int[chunkSizeX * chunkSizeZ];
-    int* maxY = new int[chunkSizeX * chunkSizeZ];
-    for (uint32_t chunkZ = chunkStartZ; chunkZ < chunkStartX + chunkSizeX; chunkZ++) {
-        for (uint32_t chunkX = chunkStartX; chunkX < chunkStartZ + chunkSizeZ; chunkX++) {
-            int chunkMinY = VERTICAL_SIZE;
-            int chunkMaxY = 0;
-            for (uint32_t i = IDIndexes[(chunkX + chunkZ * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE]; i < IDIndexes[(chunkX + chunkZ * HORIZONTAL_CHUNKS + 1) * CHUNK_SIZE * CHUNK_SIZE]; i += 2) {
-                if (IDs[i] < chunkMinY) chunkMinY = IDs[i];
-                if (IDs[i] > chunkMaxY) chunkMaxY = IDs[i];
-            }
-            minY[chunkX - chunkStartX + (chunkZ - chunkStartZ) * chunkSizeZ] = chunkMinY;
-            maxY[chunkX - chunkStartX + (chunkZ - chunkStartZ) * chunkSizeZ] = chunkMaxY;
+// chunkIDs: ID of each solid block of the chunk being meshed (chunkSize^3 bytes, index of (x, y, z) : x + y * chunkSize + z * chunkSize^2),
+// filled by generateBinarySolidBlocks() so that getID() doesn't search columns. Only solid blocks are written, other values are left from previous chunks.
+// touchedPlanes: true for each plane (chunkSize rows of planes, index of the first row / chunkSize) containing faces.
+// Planes are only scanned if they are touched, and cleared after they are meshed, so they are never cleared as a whole
+// (they stay cleared in the meshing context between calls).
 
-            for (uint32_t i = 1 + IDIndexes[(chunkX + chunkZ * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE]; i < IDIndexes[(chunkX + chunkZ * HORIZONTAL_CHUNKS + 1) * CHUNK_SIZE * CHUNK_SIZE]; i += 2) {
-                if (IDs[i] != 0 && !containedIDs[IDs[i]]) {
-                    containedIDs[IDs[i]] = true;
-                    idCount++;
-                }
-            }
+// Blocks generated for a chunk column by one thread
+struct ChunkOutput {
+    uint32_t thread;
+    uint32_t meshStart;
+    uint32_t meshEnd;
+    uint32_t squareStart;
+    uint32_t squareEnd;
+};
+
+// Cell of a chunk column downsampled for a level of detail (grid of the chunk column: index of (x, y, z) : x + z * size + y * size^2)
+struct LodCell {
+    uint8_t id; // Majority ID of the faces in the cell (Boyer-Moore majority vote)
+    uint16_t votes; // Votes for id not cancelled by votes for other IDs
+};
+
+static constexpr int lodRowCount = 7; // Rows of bits for each (y, z) of a level: cells with faces of each normal, then cells with faces
+
+// Buffers of the levels of detail of a chunk column, for one thread (all nullptr: levels of detail not generated)
+struct LodBuffers {
+    LodCell* cells; // Cells of each level (see lodGridStart()), only valid if they have faces
+    uint32_t* rows; // Rows of bits of each level, bit x of the rows of (y, z) is cell (x, y, z) (index of the first row : (z + y * size) * lodRowCount)
+    uint8_t* planeIDs; // ID of the faces of a downsampled chunk (index of (x, y) of plane (normal, depth) : x + ((normal * size + depth) * size + y) * size)
+    uint32_t* planeRows; // Faces of a downsampled chunk: bit x of row y of plane (normal, depth), cleared when they are meshed (index : (normal * size + depth) * size + y)
+};
+
+// Add the meshes to the output vectors of generateMesh()
+class VoxelMeshSink : public MeshSink {
+public:
+    VoxelMeshSink(vector<VoxelMesh>& meshes, vector<Square>& squares) : meshes(meshes), squares(squares) { }
+
+    void addMeshes(uint32_t, uint32_t, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) override {
+        this->meshes.insert(this->meshes.end(), meshes, meshes + meshCount);
+        this->squares.insert(this->squares.end(), squares, squares + squareCount);
+    }
+
+private:
+    vector<VoxelMesh>& meshes;
+    vector<Square>& squares;
+};
+
+// Published columns (see PublishedColumns.hpp) of a region and of the chunk columns around it, loaded once by a reader
+// so that each chunk column is meshed from one version
+class PinnedColumns {
+public:
+    WorldConfig world;
+
+    PinnedColumns(const PublishedColumns& columns, uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, MeshingContext& context) :
+        world(columns.world),
+        startX(chunkStartX > 0 ? chunkStartX - 1 : 0),
+        startZ(chunkStartZ > 0 ? chunkStartZ - 1 : 0),
+        sizeX(std::min(chunkStartX + chunkSizeX + 1, (uint32_t)world.horizontalChunks) - startX) {
+        uint32_t sizeZ = std::min(chunkStartZ + chunkSizeZ + 1, (uint32_t)world.horizontalChunks) - startZ;
+        chunks = context.get<const CompactColumns*>(MeshingBuffer::pinnedChunks, sizeX * sizeZ);
+        for (uint32_t z = 0; z < sizeZ; z++) {
+            for (uint32_t x = 0; x < sizeX; x++) chunks[x + z * sizeX] = &columns.chunk(startX + x + (startZ + z) * world.horizontalChunks);
         }
     }
 
+    const CompactColumns& chunk(uint32_t chunk) const {
+        uint32_t chunkX = chunk % world.horizontalChunks;
+        uint32_t chunkZ = chunk / world.horizontalChunks;
+        return *chunks[chunkX - startX + (chunkZ - startZ) * sizeX];
+    }
+
+private:
+    uint32_t startX;
+    uint32_t startZ;
+    uint32_t sizeX;
+    const CompactColumns** chunks;
+};
+
+template<int chunkSize, typename Blocks> void generateBlocksMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const Blocks& blocks, MeshSink& sink, MeshingContext& context, uint32_t threadCount, const OccupancySummary* occupancy);
+template<int chunkSize, typename Blocks> double benchmarkBlocksFaceClassification(const Blocks& blocks);
+template<int chunkSize, typename Blocks> void generateChunkColumnMesh(uint32_t chunkX, uint32_t chunkZ, int xzStartY, int sizeY, const Blocks& blocks, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* idToIndex, int* indexToId, int idCount, const OccupancySummary* occupancy, const LodBuffers& lod, vector<VoxelMesh>& meshes, vector<Square>& squares);
+template<int chunkSize, typename Blocks> void generateBinaryPlanes(uint32_t chunkX, uint32_t chunkZ, int startY, const Blocks& blocks, ChunkRow<chunkSize>* rows, bvec2* sides, const uint8_t* chunkIDs, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* idToIndex, int idCount);
+template<int chunkSize, uint32_t axis, typename Blocks> void generateAxisBinaryPlanes(uint32_t chunkX, uint32_t chunkZ, int startY, const Blocks& blocks, ChunkRow<chunkSize>* rows, bvec2* sides, const uint8_t* chunkIDs, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* idToIndex, int idCount);
+template<int chunkSize> void generateXZSides(bool after, int startIndex, bvec2* sides);
+template<int chunkSize> void generateOtherAxesRows(int axis, ChunkRow<chunkSize>* rows);
+template<int chunkSize> void transposeRows(ChunkRow<chunkSize>* matrix);
+
+// Each block storage provides findChunkBlocks(), generateBinarySolidBlocks() and getID()
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const CompactColumnsView& columns, int& minY, int& maxY, bool* containedIDs);
+template<int chunkSize> void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const CompactColumnsView& columns, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs);
+template<int chunkSize> void generateColumnRows(uint32_t xzIndex, int startY, const CompactColumnsView& columns, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs);
+template<int chunkSize> void addSolidBlocks(int x, int z, int startY, int endY, ChunkRow<chunkSize>* rows, uint8_t* chunkIDs);
+template<int chunkSize> void generateChunkSide(const CompactColumnsView* columns, uint32_t xzIndex, uint32_t xzStep, bool after, int startIndex, int startY, bvec2* sides);
+template<int chunkSize> void generateXZSides(uint32_t xzIndex, bool after, int startIndex, int startY, const CompactColumnsView& columns, bvec2* sides);
+template<int chunkSize> int getID(ivec3 pos, uint32_t chunkX, uint32_t chunkZ, int startY, const CompactColumnsView& columns, const uint8_t* chunkIDs);
+
+// Chunk columns stored separately (ChunkedColumns, or published columns pinned by a reader) are read like compact columns,
+// each chunk column being a world of one chunk column
+template<int chunkSize, typename Chunks> void findChunkColumnBlocks(uint32_t chunkX, uint32_t chunkZ, const Chunks& chunks, int& minY, int& maxY, bool* containedIDs);
+template<int chunkSize, typename Chunks> void generateChunkColumnSolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const Chunks& chunks, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs);
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const ChunkedColumns& columns, int& minY, int& maxY, bool* containedIDs);
+template<int chunkSize> void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const ChunkedColumns& columns, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs);
+template<int chunkSize> int getID(ivec3 pos, uint32_t chunkX, uint32_t chunkZ, int startY, const ChunkedColumns& columns, const uint8_t* chunkIDs);
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const PinnedColumns& columns, int& minY, int& maxY, bool* containedIDs);
+template<int chunkSize> void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const PinnedColumns& columns, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs);
+template<int chunkSize> int getID(ivec3 pos, uint32_t chunkX, uint32_t chunkZ, int startY, const PinnedColumns& columns, const uint8_t* chunkIDs);
+
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const PalettedChunks& chunks, int& minY, int& maxY, bool* containedIDs);
+template<int chunkSize> void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const PalettedChunks& chunks, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs);
+template<int chunkSize> int getID(ivec3 pos, uint32_t chunkX, uint32_t chunkZ, int startY, const PalettedChunks& chunks, const uint8_t* chunkIDs);
+
+// Height maps skip solid blocks and face classification, their faces are added to planes directly
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const HeightMap& heightMap, int& minY, int& maxY, bool* containedIDs);
+template<int chunkSize> void generateHeightMapPlanes(uint32_t chunkX, uint32_t chunkZ, int startY, const HeightMap& heightMap, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* idToIndex, int idCount);
+
+template<int chunkSize> void generateOptimizedMesh(uint32_t chunkX, uint32_t chunkZ, int startY, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* indexToId, int idCount, vector<VoxelMesh>& meshes, vector<Square>& squares);
+template<int chunkSize, CubeNormal normal> void generateNormalOptimizedMesh(uint32_t chunkX, uint32_t chunkZ, int startY, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* indexToId, int idCount, vector<VoxelMesh>& meshes, vector<Square>& squares);
+template<int chunkSize, CubeNormal normal> void generateOptimizedPlane(int depth, int idIndex, VoxelMesh& mesh, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* indexToId, int idCount, vector<Square>& squares);
+
+// Levels of detail are downsampled from the face planes of each chunk (before they are meshed), then meshed once the whole chunk column is downsampled
+template<int chunkSize, int dimensions> uint32_t lodGridStart(uint32_t lod, int verticalChunks);
+template<int chunkSize> void downsamplePlanes(int chunkY, int verticalChunks, const ChunkRow<chunkSize>* planes, const bool* touchedPlanes, const int* indexToId, int idCount, const LodBuffers& lod);
+template<int chunkSize, CubeNormal normal> void downsampleNormalPlanes(const ChunkRow<chunkSize>* planes, const bool* touchedPlanes, const int* indexToId, int idCount, LodCell* cells, uint32_t* rows);
+void downsampleCells(int size, const LodCell* cells, const uint32_t* rows, LodCell* coarseCells, uint32_t* coarseRows);
+uint32_t downsampleRow(uint32_t row);
+void voteCell(LodCell& cell, uint8_t id, uint16_t votes);
+template<int chunkSize> void generateLodMesh(uint32_t chunkX, uint32_t chunkZ, int xzStartY, int chunkCount, const WorldConfig& world, const LodBuffers& lod, vector<VoxelMesh>& meshes, vector<Square>& squares);
+template<CubeNormal normal> void addLodFaces(uint32_t faces, int y, int z, int size, const LodCell* rowCells, uint8_t* planeIDs, uint32_t* planeRows);
+template<int chunkSize, CubeNormal normal> void generateLodNormalMesh(uint32_t chunkX, uint32_t chunkZ, int startY, uint32_t lod, uint8_t* planeIDs, uint32_t* planeRows, vector<VoxelMesh>& meshes, vector<Square>& squares);
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const WorldConfig& world, int* IDs, uint32_t* IDIndexes, vector<VoxelMesh>& meshes, vector<Square>& squares, uint32_t threadCount) {
+    CompactColumns columns(world, IDs, IDIndexes);
+    generateMesh(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns, meshes, squares, threadCount);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const CompactColumns& columns, vector<VoxelMesh>& meshes, vector<Square>& squares, uint32_t threadCount) {
+    generateMesh(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns.view(), meshes, squares, threadCount);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const CompactColumnsView& columns, vector<VoxelMesh>& meshes, vector<Square>& squares, uint32_t threadCount) {
+    MeshingContext context;
+    generateMesh(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns, meshes, squares, context, threadCount);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const CompactColumnsView& columns, vector<VoxelMesh>& meshes, vector<Square>& squares, MeshingContext& context, uint32_t threadCount) {
+    VoxelMeshSink sink(meshes, squares);
+    generateMesh(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns, sink, context, threadCount);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const CompactColumnsView& columns, MeshSink& sink, MeshingContext& context, uint32_t threadCount, const OccupancySummary* occupancy) {
+    if (columns.world.chunkSize == 32) generateBlocksMesh<32>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns, sink, context, threadCount, occupancy);
+    else generateBlocksMesh<64>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns, sink, context, threadCount, occupancy);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const ChunkedColumns& columns, vector<VoxelMesh>& meshes, vector<Square>& squares, uint32_t threadCount) {
+    MeshingContext context;
+    VoxelMeshSink sink(meshes, squares);
+    generateMesh(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns, sink, context, threadCount);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const ChunkedColumns& columns, MeshSink& sink, MeshingContext& context, uint32_t threadCount) {
+    if (columns.world.chunkSize == 32) generateBlocksMesh<32>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns, sink, context, threadCount, nullptr);
+    else generateBlocksMesh<64>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, columns, sink, context, threadCount, nullptr);
+}
+
+
+// The chunk columns are pinned before meshing, then read until the end of meshing
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const PublishedColumns& columns, uint32_t reader, MeshSink& sink, MeshingContext& context, uint32_t threadCount) {
+    uint32_t horizontalChunks = columns.world.horizontalChunks;
+    if (chunkStartX > horizontalChunks || chunkSizeX > horizontalChunks - chunkStartX || chunkStartZ > horizontalChunks || chunkSizeZ > horizontalChunks - chunkStartZ) {
+        throw runtime_error("Region outside of the world");
+    }
+    PublishedRead read(columns, reader);
+    PinnedColumns pinned(columns, chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, context);
+    if (columns.world.chunkSize == 32) generateBlocksMesh<32>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, pinned, sink, context, threadCount, nullptr);
+    else generateBlocksMesh<64>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, pinned, sink, context, threadCount, nullptr);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const PalettedChunks& chunks, vector<VoxelMesh>& meshes, vector<Square>& squares, uint32_t threadCount) {
+    MeshingContext context;
+    generateMesh(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, chunks, meshes, squares, context, threadCount);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const PalettedChunks& chunks, vector<VoxelMesh>& meshes, vector<Square>& squares, MeshingContext& context, uint32_t threadCount) {
+    VoxelMeshSink sink(meshes, squares);
+    generateMesh(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, chunks, sink, context, threadCount);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const PalettedChunks& chunks, MeshSink& sink, MeshingContext& context, uint32_t threadCount, const OccupancySummary* occupancy) {
+    if (chunks.world.chunkSize == 32) generateBlocksMesh<32>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, chunks, sink, context, threadCount, occupancy);
+    else generateBlocksMesh<64>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, chunks, sink, context, threadCount, occupancy);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const HeightMap& heightMap, vector<VoxelMesh>& meshes, vector<Square>& squares, uint32_t threadCount) {
+    MeshingContext context;
+    VoxelMeshSink sink(meshes, squares);
+    generateMesh(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, heightMap, sink, context, threadCount);
+}
+
+
+void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const HeightMap& heightMap, MeshSink& sink, MeshingContext& context, uint32_t threadCount) {
+    if (heightMap.world.chunkSize == 32) generateBlocksMesh<32>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, heightMap, sink, context, threadCount, nullptr);
+    else generateBlocksMesh<64>(chunkStartX, chunkStartZ, chunkSizeX, chunkSizeZ, heightMap, sink, context, threadCount, nullptr);
+}
+
+
+double benchmarkFaceClassification(const CompactColumnsView& columns) {
+    if (columns.world.chunkSize == 32) return benchmarkBlocksFaceClassification<32>(columns);
+    return benchmarkBlocksFaceClassification<64>(columns);
+}
+
+
+template<int chunkSize, typename Blocks> void generateBlocksMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSizeX, uint32_t chunkSizeZ, const Blocks& blocks, MeshSink& sink, MeshingContext& context, uint32_t threadCount, const OccupancySummary* occupancy) {
+    typedef ChunkRow<chunkSize> Row;
+    uint32_t horizontalChunks = blocks.world.horizontalChunks;
+    if (chunkStartX > horizontalChunks || chunkSizeX > horizontalChunks - chunkStartX || chunkStartZ > horizontalChunks || chunkSizeZ > horizontalChunks - chunkStartZ) {
+        throw runtime_error("Region outside of the world");
+    }
+    if (occupancy != nullptr && !(occupancy->world == blocks.world)) throw runtime_error("Occupancy summary of another world");
+
+    // Find IDs in area and y range for each (x, z) chunk (chunks outside the region are only read for the faces on its border)
+    bool* containedIDs = context.get<bool>(MeshingBuffer::containedIDs, 256);
+    int* minY = context.get<int>(MeshingBuffer::minY, chunkSizeX * chunkSizeZ);
+    int* maxY = context.get<int>(MeshingBuffer::maxY, chunkSizeX * chunkSizeZ);
+    fill(containedIDs, containedIDs + 256, false);
+    for (uint32_t chunkZ = chunkStartZ; chunkZ < chunkStartZ + chunkSizeZ; chunkZ++) {
+        for (uint32_t chunkX = chunkStartX; chunkX < chunkStartX + chunkSizeX; chunkX++) {
+            findChunkBlocks<chunkSize>(chunkX, chunkZ, blocks, minY[chunkX - chunkStartX + (chunkZ - chunkStartZ) * chunkSizeX], maxY[chunkX - chunkStartX + (chunkZ - chunkStartZ) * chunkSizeX], containedIDs);
+        }
+    }
+    containedIDs[0] = false; // Invisible blocks are never rendered
+    int idCount = 0;
+    for (int id = 0; id < 256; id++) {
+        if (containedIDs[id]) idCount++;
+    }
+
     // Map contained IDs to smallest range possible
-    int* idToIndex = new int[256];
-    int* indexToId = new int[idCount];
+    int* idToIndex = context.get<int>(MeshingBuffer::idToIndex, 256);
+    int* indexToId = context.get<int>(MeshingBuffer::indexToId, idCount);
     int index = 0;
     for (int id = 0; id < 256; id++) {
         if (containedIDs[id]) {
@@ -59,154 +289,576 @@ void generateMesh(uint32_t chunkStartX, uint32_t chunkStartZ, uint32_t chunkSize
             index++;
         }
     }
-    delete[] containedIDs;
 
-    // Generate all chunks
-    uint64_t* rows = new uint64_t[CHUNK_SIZE * CHUNK_SIZE * 3];
-    bvec2* sides = new bvec2[CHUNK_SIZE * CHUNK_SIZE * 3];
-    uint64_t* planes = new uint64_t[CHUNK_SIZE * CHUNK_SIZE * idCount * 6];
-    for (uint32_t chunkZ = chunkStartZ; chunkZ < chunkStartZ + chunkSizeZ; chunkZ++) {
-        for (uint32_t chunkX = chunkStartX; chunkX < chunkStartX + chunkSizeX; chunkX++) {
-            uint32_t startXZIndex = (chunkX + chunkZ * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE;
-            int xzStartY = minY[chunkX - chunkStartX + (chunkZ - chunkStartZ) * chunkSizeZ];
-            int sizeY = maxY[chunkX - chunkStartX + (chunkZ - chunkStartZ) * chunkSizeZ] - xzStartY + 1;
-            for (int chunkY = 0; chunkY < (int)ceil((float)sizeY / CHUNK_SIZE); chunkY++) {
-                // Generate one chunk
-                fill(rows, rows + CHUNK_SIZE * CHUNK_SIZE * 3, 0);
-                fill(sides, sides + CHUNK_SIZE * CHUNK_SIZE * 3, bvec2(false, false));
-                fill(planes, planes + CHUNK_SIZE * CHUNK_SIZE * idCount * 6, 0);
-                int startY = xzStartY + chunkY * CHUNK_SIZE;
-                generateBinarySolidBlocks(chunkX, chunkZ, startY, IDs, IDIndexes, rows, sides);
-                generateBinaryPlanes(startXZIndex, startY, IDs, IDIndexes, rows, sides, planes, idToIndex, idCount);
-                generateOptimizedMesh(chunkX, chunkZ, startY, planes, indexToId, idCount, meshes, squares);
+    // Generate all chunks, each thread with its own buffers and output vectors.
+    // With one thread, each chunk column is given to the sink as soon as it is generated.
+    // With several threads, chunk columns are given to the sink in chunk order once all threads are done.
+    if (threadCount == 0) threadCount = defaultThreadCount();
+    uint32_t chunkCount = chunkSizeX * chunkSizeZ;
+    Row* rows = context.get<Row>(MeshingBuffer::rows, chunkSize * chunkSize * 3 * threadCount);
+    bvec2* sides = context.get<bvec2>(MeshingBuffer::sides, chunkSize * chunkSize * 3 * threadCount);
+    uint8_t* chunkIDs = context.get<uint8_t>(MeshingBuffer::chunkIDs, chunkSize * chunkSize * chunkSize * threadCount);
+    Row* planes = context.get<Row>(MeshingBuffer::planes, chunkSize * chunkSize * idCount * 6 * threadCount); // Cleared (see touchedPlanes)
+    bool* touchedPlanes = context.get<bool>(MeshingBuffer::touchedPlanes, chunkSize * idCount * 6 * threadCount);
+    vector<VoxelMesh>* threadMeshes = context.threadMeshes(threadCount);
+    vector<Square>* threadSquares = context.threadSquares(threadCount);
+    ChunkOutput* chunkOutputs = threadCount > 1 ? context.get<ChunkOutput>(MeshingBuffer::chunkOutputs, chunkCount) : nullptr;
+    uint32_t lodColumnCells = lodGridStart<chunkSize, 3>(lodCount + 1, blocks.world.verticalChunks);
+    uint32_t lodColumnRows = lodGridStart<chunkSize, 2>(lodCount + 1, blocks.world.verticalChunks) * lodRowCount;
+    constexpr int lodSize = chunkSize / 2; // Size of the largest downsampled chunks
+    LodCell* lodCells = nullptr;
+    uint32_t* lodRows = nullptr;
+    uint8_t* lodPlaneIDs = nullptr;
+    uint32_t* lodPlaneRows = nullptr;
+    if (context.levelsOfDetail()) {
+        lodCells = context.get<LodCell>(MeshingBuffer::lodCells, lodColumnCells * threadCount);
+        lodRows = context.get<uint32_t>(MeshingBuffer::lodRows, lodColumnRows * threadCount); // Cleared by chunk (see downsamplePlanes())
+        lodPlaneIDs = context.get<uint8_t>(MeshingBuffer::lodPlaneIDs, 6 * lodSize * lodSize * lodSize * threadCount);
+        lodPlaneRows = context.get<uint32_t>(MeshingBuffer::lodPlaneRows, 6 * lodSize * lodSize * threadCount); // Cleared (see LodBuffers)
+    }
+    auto generateChunk = [&](uint32_t chunk, uint32_t thread) {
+        uint32_t chunkX = chunkStartX + chunk % chunkSizeX;
+        uint32_t chunkZ = chunkStartZ + chunk / chunkSizeX;
+        int xzStartY = minY[chunk];
+        int sizeY = maxY[chunk] - xzStartY + 1;
+        vector<VoxelMesh>& chunkMeshes = threadMeshes[thread];
+        vector<Square>& chunkSquares = threadSquares[thread];
+        if (threadCount > 1) chunkOutputs[chunk] = ChunkOutput { thread, (uint32_t)chunkMeshes.size(), 0, (uint32_t)chunkSquares.size(), 0 };
+        generateChunkColumnMesh<chunkSize>(
+            chunkX, chunkZ, xzStartY, sizeY, blocks,
+            rows + chunkSize * chunkSize * 3 * thread, sides + chunkSize * chunkSize * 3 * thread, chunkIDs + chunkSize * chunkSize * chunkSize * thread,
+            planes + chunkSize * chunkSize * idCount * 6 * thread, touchedPlanes + chunkSize * idCount * 6 * thread,
+            idToIndex, indexToId, idCount, occupancy,
+            context.levelsOfDetail() ? LodBuffers {
+                lodCells + lodColumnCells * thread, lodRows + lodColumnRows * thread,
+                lodPlaneIDs + 6 * lodSize * lodSize * lodSize * thread, lodPlaneRows + 6 * lodSize * lodSize * thread
+            } : LodBuffers { nullptr, nullptr, nullptr, nullptr },
+            chunkMeshes, chunkSquares
+        );
+        if (threadCount > 1) {
+            chunkOutputs[chunk].meshEnd = chunkMeshes.size();
+            chunkOutputs[chunk].squareEnd = chunkSquares.size();
+        }
+        else {
+            sink.addMeshes(chunkX, chunkZ, chunkMeshes.data(), chunkMeshes.size(), chunkSquares.data(), chunkSquares.size());
+            chunkMeshes.clear();
+            chunkSquares.clear();
+        }
+    };
+    parallelFor(chunkCount, threadCount, ref(generateChunk)); // Reference, so that the function doesn't allocate a copy of the lambda
+    if (threadCount > 1) {
+        for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+            const ChunkOutput& output = chunkOutputs[chunk];
+            vector<VoxelMesh>& chunkMeshes = threadMeshes[output.thread];
+            vector<Square>& chunkSquares = threadSquares[output.thread];
+            sink.addMeshes(
+                chunkStartX + chunk % chunkSizeX, chunkStartZ + chunk / chunkSizeX,
+                chunkMeshes.data() + output.meshStart, output.meshEnd - output.meshStart,
+                chunkSquares.data() + output.squareStart, output.squareEnd - output.squareStart
+            );
+        }
+    }
+}
+
+
+// Same steps as generateBlocksMesh() without greedy meshing
+template<int chunkSize, typename Blocks> double benchmarkBlocksFaceClassification(const Blocks& blocks) {
+    typedef ChunkRow<chunkSize> Row;
+    MeshingContext context;
+    int horizontalChunks = blocks.world.horizontalChunks;
+    bool* containedIDs = context.get<bool>(MeshingBuffer::containedIDs, 256);
+    int* minY = context.get<int>(MeshingBuffer::minY, horizontalChunks * horizontalChunks);
+    int* maxY = context.get<int>(MeshingBuffer::maxY, horizontalChunks * horizontalChunks);
+    for (int chunk = 0; chunk < horizontalChunks * horizontalChunks; chunk++) {
+        findChunkBlocks<chunkSize>(chunk % horizontalChunks, chunk / horizontalChunks, blocks, minY[chunk], maxY[chunk], containedIDs);
+    }
+    containedIDs[0] = false;
+    int* idToIndex = context.get<int>(MeshingBuffer::idToIndex, 256);
+    int idCount = 0;
+    for (int id = 0; id < 256; id++) {
+        if (containedIDs[id]) idToIndex[id] = idCount++;
+    }
+    Row* rows = context.get<Row>(MeshingBuffer::rows, chunkSize * chunkSize * 3);
+    bvec2* sides = context.get<bvec2>(MeshingBuffer::sides, chunkSize * chunkSize * 3);
+    uint8_t* chunkIDs = context.get<uint8_t>(MeshingBuffer::chunkIDs, chunkSize * chunkSize * chunkSize);
+    Row* planes = context.get<Row>(MeshingBuffer::planes, chunkSize * chunkSize * idCount * 6);
+    bool* touchedPlanes = context.get<bool>(MeshingBuffer::touchedPlanes, chunkSize * idCount * 6);
+
+    uint64_t faces = 0;
+    double seconds = 0;
+    for (int chunk = 0; chunk < horizontalChunks * horizontalChunks; chunk++) {
+        for (int startY = minY[chunk]; startY <= maxY[chunk]; startY += chunkSize) {
+            fill(rows, rows + chunkSize * chunkSize * 3, 0);
+            fill(sides, sides + chunkSize * chunkSize * 3, bvec2(false, false));
+            steady_clock::time_point start = steady_clock::now();
+            generateBinarySolidBlocks<chunkSize>(chunk % horizontalChunks, chunk / horizontalChunks, startY, blocks, rows, sides, chunkIDs);
+            generateBinaryPlanes<chunkSize>(chunk % horizontalChunks, chunk / horizontalChunks, startY, blocks, rows, sides, chunkIDs, planes, touchedPlanes, idToIndex, idCount);
+            seconds += duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1e9;
+            for (int plane = 0; plane < chunkSize * idCount * 6; plane++) {
+                if (!touchedPlanes[plane]) continue;
+                for (int i = plane * chunkSize; i < (plane + 1) * chunkSize; i++) faces += __builtin_popcountll(planes[i]);
+                fill(planes + plane * chunkSize, planes + (plane + 1) * chunkSize, 0);
+                touchedPlanes[plane] = false;
             }
         }
     }
+    return faces / seconds / 1e6;
+}
+
+
+// Generate all chunks of a chunk column, then its levels of detail (if lod has buffers)
+template<int chunkSize, typename Blocks> void generateChunkColumnMesh(uint32_t chunkX, uint32_t chunkZ, int xzStartY, int sizeY, const Blocks& blocks, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* idToIndex, int* indexToId, int idCount, const OccupancySummary* occupancy, const LodBuffers& lod, vector<VoxelMesh>& meshes, vector<Square>& squares) {
+    int chunkCount = (int)ceil((float)sizeY / chunkSize);
+    for (int chunkY = 0; chunkY < chunkCount; chunkY++) {
+        // Generate one chunk (if it can have faces)
+        int startY = xzStartY + chunkY * chunkSize;
+        if (occupancy != nullptr && !occupancy->canHaveFaces(chunkX, chunkZ, startY, startY + chunkSize)) {
+            if (lod.cells != nullptr) downsamplePlanes<chunkSize>(chunkY, blocks.world.verticalChunks, planes, touchedPlanes, indexToId, 0, lod); // No faces
+            continue;
+        }
+        if constexpr (is_same<Blocks, HeightMap>::value) generateHeightMapPlanes<chunkSize>(chunkX, chunkZ, startY, blocks, planes, touchedPlanes, idToIndex, idCount);
+        else {
+            fill(rows, rows + chunkSize * chunkSize * 3, 0);
+            fill(sides, sides + chunkSize * chunkSize * 3, bvec2(false, false));
+            generateBinarySolidBlocks<chunkSize>(chunkX, chunkZ, startY, blocks, rows, sides, chunkIDs);
+            generateBinaryPlanes<chunkSize>(chunkX, chunkZ, startY, blocks, rows, sides, chunkIDs, planes, touchedPlanes, idToIndex, idCount);
+        }
+        if (lod.cells != nullptr) downsamplePlanes<chunkSize>(chunkY, blocks.world.verticalChunks, planes, touchedPlanes, indexToId, idCount, lod);
+        generateOptimizedMesh<chunkSize>(chunkX, chunkZ, startY, planes, touchedPlanes, indexToId, idCount, meshes, squares);
+    }
+    if (lod.cells != nullptr) generateLodMesh<chunkSize>(chunkX, chunkZ, xzStartY, chunkCount, blocks.world, lod, meshes, squares);
+}
+
+
+// Find the y range of a chunk column and the IDs it contains
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const CompactColumnsView& columns, int& minY, int& maxY, bool* containedIDs) {
+    minY = columns.world.verticalSize;
+    maxY = 0;
+    uint32_t chunk = chunkX + chunkZ * columns.world.horizontalChunks;
+    uint32_t startXZIndex = chunk * chunkSize * chunkSize;
+    for (uint32_t xzIndex = startXZIndex; xzIndex < startXZIndex + chunkSize * chunkSize; xzIndex++) {
+        uint32_t end = columns.index.end<chunkSize>(xzIndex);
+        if (columns.index.start<chunkSize>(xzIndex) == end) continue; // Empty column
+        if (columns.bottoms[xzIndex] < minY) minY = columns.bottoms[xzIndex];
+        if (columns.ys[end - 1] > maxY) maxY = columns.ys[end - 1];
+    }
 
-    delete[] minY;
-    delete[] maxY;
-    delete[] idToIndex;
-    delete[] indexToId;
-    delete[] rows;
-    delete[] sides;
-    delete[] planes;
+    for (uint32_t i = columns.index.chunkStart(chunk); i < columns.index.chunkStart(chunk + 1); i++) {
+        containedIDs[columns.ids[i]] = true;
+    }
 }
 
 
 // rows: bit rows containing 1 if the block is solid, 0 otherwise
 // sides: 2 bools, first is true if the block before the row is solid, 0 otherwise, second is true if the block after the row is solid, 0 otherwise
 // rows and sides contain chunkSize * chunkSize elements for each axis (x, z, y)
-void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, int* IDs, uint32_t* IDIndexes, uint64_t* rows, bvec2* sides) {
-    uint32_t xzIndex = (chunkX + chunkZ * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE;
-    for (int z = 0; z < CHUNK_SIZE; z++) { // Iter chunk z
-        for (int x = 0; x < CHUNK_SIZE; x++) { // Iter chunk x
+template<int chunkSize> void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const CompactColumnsView& columns, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs) {
+    int horizontalChunks = columns.world.horizontalChunks;
+    uint32_t chunk = chunkX + chunkZ * horizontalChunks;
+    generateColumnRows<chunkSize>(chunk * chunkSize * chunkSize, startY, columns, rows, sides, chunkIDs);
+
+    // x and z sides (columns of the next chunks on their border)
+    const CompactColumnsView* before = chunkX > 0 ? &columns : nullptr;
+    const CompactColumnsView* after = (int)chunkX < horizontalChunks - 1 ? &columns : nullptr;
+    generateChunkSide<chunkSize>(before, (chunk - 1) * chunkSize * chunkSize + chunkSize - 1, chunkSize, false, 0, startY, sides);
+    generateChunkSide<chunkSize>(after, (chunk + 1) * chunkSize * chunkSize, chunkSize, true, 0, startY, sides);
+    before = chunkZ > 0 ? &columns : nullptr;
+    after = (int)chunkZ < horizontalChunks - 1 ? &columns : nullptr;
+    generateChunkSide<chunkSize>(before, (chunk - horizontalChunks) * chunkSize * chunkSize + (chunkSize - 1) * chunkSize, 1, false, 2 * chunkSize * chunkSize, startY, sides);
+    generateChunkSide<chunkSize>(after, (chunk + horizontalChunks) * chunkSize * chunkSize, 1, true, 2 * chunkSize * chunkSize, startY, sides);
+}
+
+
+// Rows and y sides of the chunkSize^2 columns of a chunk starting at xzIndex
+template<int chunkSize> void generateColumnRows(uint32_t xzIndex, int startY, const CompactColumnsView& columns, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs) {
+    typedef ChunkRow<chunkSize> Row;
+    for (int z = 0; z < chunkSize; z++) { // Iter chunk z
+        for (int x = 0; x < chunkSize; x++) { // Iter chunk x
             bvec2 ySide = bvec2(false, false);
-            for (uint32_t i = IDIndexes[xzIndex]; i < IDIndexes[xzIndex + 1]; i += 2) { // Iter world y (only solid blocks in chunk)
-                int y = IDs[i] - startY;
-                if (y >= 0 && y < CHUNK_SIZE) {
-                    rows[y + z * CHUNK_SIZE] |= (uint64_t)1 << x; // x
-                    rows[x + z * CHUNK_SIZE + CHUNK_SIZE * CHUNK_SIZE] |= (uint64_t)1 << y; // y
-                    rows[y + x * CHUNK_SIZE + 2 * CHUNK_SIZE * CHUNK_SIZE] |= (uint64_t)1 << z; // z
+            uint32_t start = columns.index.start<chunkSize>(xzIndex);
+            uint32_t end = columns.index.end<chunkSize>(xzIndex);
+            if (start != end) {
+                // Invisible blocks below the first block
+                int bottom = columns.bottoms[xzIndex] - startY;
+                int top = columns.ys[start] - startY;
+                addSolidBlocks<chunkSize>(x, z, std::max(bottom, 0), std::min(top, chunkSize), rows, chunkIDs);
+                if (bottom <= -1 && top > -1) ySide.x = true;
+                if (bottom <= chunkSize && top > chunkSize) ySide.y = true;
+            }
+            for (uint32_t i = start; i < end; i++) { // Iter world y (only stored blocks)
+                int y = columns.ys[i] - startY;
+                if (y >= 0 && y < chunkSize) {
+                    rows[x + z * chunkSize + chunkSize * chunkSize] |= (Row)1 << y; // y
+                    chunkIDs[x + y * chunkSize + z * chunkSize * chunkSize] = columns.ids[i];
                 }
                 else if (y == -1) ySide.x = true;
-                else if (y == CHUNK_SIZE) ySide.y = true;
+                else if (y == chunkSize) ySide.y = true;
             }
-            sides[x + z * CHUNK_SIZE + CHUNK_SIZE * CHUNK_SIZE] = ySide;
+            sides[x + z * chunkSize + chunkSize * chunkSize] = ySide;
             xzIndex++;
         }
     }
+    generateOtherAxesRows<chunkSize>(1, rows);
+}
+
+
+// Side rows of one x or z side of a chunk from the chunkSize columns next to it, starting at xzIndex (every xzStep) in columns
+// (nullptr: outside of the world, filled), startIndex is the first side row
+template<int chunkSize> void generateChunkSide(const CompactColumnsView* columns, uint32_t xzIndex, uint32_t xzStep, bool after, int startIndex, int startY, bvec2* sides) {
+    if (columns == nullptr) {
+        for (int i = 0; i < chunkSize; i++) generateXZSides<chunkSize>(after, startIndex + i * chunkSize, sides);
+        return;
+    }
+    for (int i = 0; i < chunkSize; i++) generateXZSides<chunkSize>(xzIndex + i * xzStep, after, startIndex + i * chunkSize, startY, *columns, sides);
+}
+
+
+// Add invisible solid blocks from startY to endY (excluded) at (x, z) in chunk (y rows only)
+template<int chunkSize> void addSolidBlocks(int x, int z, int startY, int endY, ChunkRow<chunkSize>* rows, uint8_t* chunkIDs) {
+    typedef ChunkRow<chunkSize> Row;
+    if (startY >= endY) return;
+    rows[x + z * chunkSize + chunkSize * chunkSize] |= (~(Row)0 >> (chunkSize - (endY - startY))) << startY; // y
+    for (int y = startY; y < endY; y++) chunkIDs[x + y * chunkSize + z * chunkSize * chunkSize] = 0;
+}
+
+
+// Generate the rows of the two other axes from the rows of one axis (0: x, 1: y), which must be complete.
+// Dense chunks are transposed (cost independent of the number of blocks), sparse chunks are built block by block.
+template<int chunkSize> void generateOtherAxesRows(int axis, ChunkRow<chunkSize>* rows) {
+    typedef ChunkRow<chunkSize> Row;
+    Row* from = rows + axis * chunkSize * chunkSize;
+    Row* to = rows + (1 - axis) * chunkSize * chunkSize;
+    int blockCount = 0;
+    for (int i = 0; i < chunkSize * chunkSize; i++) blockCount += __builtin_popcountll(from[i]);
+
+    if (blockCount < transposeMinBlocks * chunkSize * chunkSize / (64 * 64)) {
+        for (int z = 0; z < chunkSize; z++) {
+            for (int i = 0; i < chunkSize; i++) {
+                for (Row row = from[i + z * chunkSize]; row != 0; row &= row - 1) {
+                    int j = __builtin_ctzll(row);
+                    to[j + z * chunkSize] |= (Row)1 << i; // y (from x) or x (from y)
+                    int x = axis == 0 ? j : i;
+                    int y = axis == 0 ? i : j;
+                    rows[y + x * chunkSize + 2 * chunkSize * chunkSize] |= (Row)1 << z; // z
+                }
+            }
+        }
+        return;
+    }
+
+    // x and y rows of a z are transposed matrices
+    for (int z = 0; z < chunkSize; z++) {
+        copy(from + z * chunkSize, from + (z + 1) * chunkSize, to + z * chunkSize);
+        transposeRows<chunkSize>(to + z * chunkSize);
+    }
+
+    // x rows (z varies) and z rows (x varies) of a y are transposed matrices
+    Row matrix[chunkSize];
+    for (int y = 0; y < chunkSize; y++) {
+        for (int z = 0; z < chunkSize; z++) matrix[z] = rows[y + z * chunkSize];
+        transposeRows<chunkSize>(matrix);
+        for (int x = 0; x < chunkSize; x++) rows[y + x * chunkSize + 2 * chunkSize * chunkSize] = matrix[x];
+    }
+}
+
+
+// Transpose a chunkSize * chunkSize bit matrix (bit j of row i becomes bit i of row j) by swapping blocks of half the size each step
+template<int chunkSize> void transposeRows(ChunkRow<chunkSize>* matrix) {
+    typedef ChunkRow<chunkSize> Row;
+    Row mask = ~(Row)0 >> (chunkSize / 2); // Low half of the bits of each block
+    for (int j = chunkSize / 2; j != 0; j >>= 1, mask ^= mask << j) {
+        for (int k = 0; k < chunkSize; k = ((k | j) + 1) & ~j) { // Rows with bit j cleared
+            Row swap = ((matrix[k] >> j) ^ matrix[k | j]) & mask;
+            matrix[k] ^= swap << j;
+            matrix[k | j] ^= swap;
+        }
+    }
+}
+
+
+// Generate side row at (x, z)
+template<int chunkSize> void generateXZSides(uint32_t xzIndex, bool after, int startIndex, int startY, const CompactColumnsView& columns, bvec2* sides) {
+    uint32_t start = columns.index.start<chunkSize>(xzIndex);
+    uint32_t end = columns.index.end<chunkSize>(xzIndex);
+    if (start == end) return;
+    int bottom = std::max(columns.bottoms[xzIndex] - startY, 0);
+    int top = std::min(columns.ys[start] - startY, chunkSize);
+    for (int y = bottom; y < top; y++) { // Invisible blocks below the first block
+        if (after) sides[startIndex + y].y = true;
+        else sides[startIndex + y].x = true;
+    }
+    for (uint32_t i = start; i < end; i++) {
+        int y = columns.ys[i] - startY;
+        if (y >= chunkSize) return;
+        if (y < 0) continue;
+        if (after) sides[startIndex + y].y = true;
+        else sides[startIndex + y].x = true;
+    }
+}
+
+
+// ID of a solid block at pos (relative to the chunk)
+template<int chunkSize> int getID(ivec3 pos, uint32_t chunkX, uint32_t chunkZ, int startY, const CompactColumnsView& columns, const uint8_t* chunkIDs) {
+    return chunkIDs[pos.x + pos.y * chunkSize + pos.z * chunkSize * chunkSize];
+}
+
+
+// Generate filled side row at (x, z)
+template<int chunkSize> void generateXZSides(bool after, int startIndex, bvec2* sides) {
+    for (int y = 0; y < chunkSize; y++) {
+        sides[startIndex + y] = bvec2(after ? sides[startIndex + y].x : true, after ? true : sides[startIndex + y].y);
+    }
+}
+
+
+template<int chunkSize, typename Chunks> void findChunkColumnBlocks(uint32_t chunkX, uint32_t chunkZ, const Chunks& chunks, int& minY, int& maxY, bool* containedIDs) {
+    findChunkBlocks<chunkSize>(0, 0, chunks.chunk(chunkX + chunkZ * chunks.world.horizontalChunks).view(), minY, maxY, containedIDs);
+}
+
+
+// The side rows are read from the chunk columns next to the chunk
+template<int chunkSize, typename Chunks> void generateChunkColumnSolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const Chunks& chunks, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs) {
+    int horizontalChunks = chunks.world.horizontalChunks;
+    uint32_t chunk = chunkX + chunkZ * horizontalChunks;
+    generateColumnRows<chunkSize>(0, startY, chunks.chunk(chunk).view(), rows, sides, chunkIDs);
+
+    CompactColumnsView next[4]; // Chunk columns before and after on x, then on z
+    if (chunkX > 0) next[0] = chunks.chunk(chunk - 1).view();
+    if ((int)chunkX < horizontalChunks - 1) next[1] = chunks.chunk(chunk + 1).view();
+    if (chunkZ > 0) next[2] = chunks.chunk(chunk - horizontalChunks).view();
+    if ((int)chunkZ < horizontalChunks - 1) next[3] = chunks.chunk(chunk + horizontalChunks).view();
+    generateChunkSide<chunkSize>(chunkX > 0 ? &next[0] : nullptr, chunkSize - 1, chunkSize, false, 0, startY, sides);
+    generateChunkSide<chunkSize>((int)chunkX < horizontalChunks - 1 ? &next[1] : nullptr, 0, chunkSize, true, 0, startY, sides);
+    generateChunkSide<chunkSize>(chunkZ > 0 ? &next[2] : nullptr, (chunkSize - 1) * chunkSize, 1, false, 2 * chunkSize * chunkSize, startY, sides);
+    generateChunkSide<chunkSize>((int)chunkZ < horizontalChunks - 1 ? &next[3] : nullptr, 0, 1, true, 2 * chunkSize * chunkSize, startY, sides);
+}
+
+
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const ChunkedColumns& columns, int& minY, int& maxY, bool* containedIDs) {
+    findChunkColumnBlocks<chunkSize>(chunkX, chunkZ, columns, minY, maxY, containedIDs);
+}
+
+
+template<int chunkSize> void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const ChunkedColumns& columns, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs) {
+    generateChunkColumnSolidBlocks<chunkSize>(chunkX, chunkZ, startY, columns, rows, sides, chunkIDs);
+}
+
+
+template<int chunkSize> int getID(ivec3 pos, uint32_t chunkX, uint32_t chunkZ, int startY, const ChunkedColumns& columns, const uint8_t* chunkIDs) {
+    return chunkIDs[pos.x + pos.y * chunkSize + pos.z * chunkSize * chunkSize];
+}
+
+
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const PinnedColumns& columns, int& minY, int& maxY, bool* containedIDs) {
+    findChunkColumnBlocks<chunkSize>(chunkX, chunkZ, columns, minY, maxY, containedIDs);
+}
+
+
+template<int chunkSize> void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const PinnedColumns& columns, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs) {
+    generateChunkColumnSolidBlocks<chunkSize>(chunkX, chunkZ, startY, columns, rows, sides, chunkIDs);
+}
+
+
+template<int chunkSize> int getID(ivec3 pos, uint32_t chunkX, uint32_t chunkZ, int startY, const PinnedColumns& columns, const uint8_t* chunkIDs) {
+    return chunkIDs[pos.x + pos.y * chunkSize + pos.z * chunkSize * chunkSize];
+}
+
+
+// Find the y range of a chunk column (whole chunks) and the IDs it contains
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const PalettedChunks& chunks, int& minY, int& maxY, bool* containedIDs) {
+    minY = chunks.world.verticalSize;
+    maxY = 0;
+    for (int chunkY = 0; chunkY < chunks.world.verticalChunks; chunkY++) {
+        const PalettedChunk& chunk = chunks.chunk(chunkX, chunkY, chunkZ);
+        if (chunk.empty()) continue;
+        if (chunkY * chunkSize < minY) minY = chunkY * chunkSize;
+        maxY = chunkY * chunkSize + chunkSize - 1;
+        for (int16_t id : chunk.palette) {
+            if (id != PalettedChunk::air) containedIDs[id] = true;
+        }
+    }
+}
+
+
+// Same as for compact columns, startY must be a multiple of chunkSize.
+// chunkIDs is not used: the chunk already gives IDs in constant time.
+template<int chunkSize> void generateBinarySolidBlocks(uint32_t chunkX, uint32_t chunkZ, int startY, const PalettedChunks& chunks, ChunkRow<chunkSize>* rows, bvec2* sides, uint8_t* chunkIDs) {
+    typedef ChunkRow<chunkSize> Row;
+    int chunkY = startY / chunkSize;
+    const PalettedChunk& chunk = chunks.chunk(chunkX, chunkY, chunkZ);
+    if (!chunk.empty()) {
+        for (int z = 0; z < chunkSize; z++) {
+            for (int y = 0; y < chunkSize; y++) {
+                rows[y + z * chunkSize] = chunk.solidRow(y, z); // x
+            }
+        }
+        generateOtherAxesRows<chunkSize>(0, rows);
+    }
+
+    // y sides (nothing below or above the world)
+    if (chunkY > 0 && !chunks.chunk(chunkX, chunkY - 1, chunkZ).empty()) {
+        const PalettedChunk& below = chunks.chunk(chunkX, chunkY - 1, chunkZ);
+        for (int z = 0; z < chunkSize; z++) {
+            Row row = below.solidRow(chunkSize - 1, z);
+            for (; row != 0; row &= row - 1) sides[__builtin_ctzll(row) + z * chunkSize + chunkSize * chunkSize].x = true;
+        }
+    }
+    if (chunkY < chunks.world.verticalChunks - 1 && !chunks.chunk(chunkX, chunkY + 1, chunkZ).empty()) {
+        const PalettedChunk& above = chunks.chunk(chunkX, chunkY + 1, chunkZ);
+        for (int z = 0; z < chunkSize; z++) {
+            Row row = above.solidRow(0, z);
+            for (; row != 0; row &= row - 1) sides[__builtin_ctzll(row) + z * chunkSize + chunkSize * chunkSize].y = true;
+        }
+    }
 
     // x and z sides
     if (chunkX > 0) {
-        uint32_t otherStartXZIndex = (chunkX - 1 + chunkZ * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE;
-        for (int z = 0; z < CHUNK_SIZE; z++)
-            generateXZSides(otherStartXZIndex + CHUNK_SIZE - 1 + z * CHUNK_SIZE, false, z * CHUNK_SIZE, startY, IDs, IDIndexes, sides);
+        const PalettedChunk& other = chunks.chunk(chunkX - 1, chunkY, chunkZ);
+        if (!other.empty()) {
+            for (int z = 0; z < chunkSize; z++) {
+                for (int y = 0; y < chunkSize; y++) sides[y + z * chunkSize].x = other.solidRow(y, z) >> (chunkSize - 1);
+            }
+        }
     }
     else {
-        for (int z = 0; z < CHUNK_SIZE; z++)
-            generateXZSides(false, z * CHUNK_SIZE, sides);
+        for (int z = 0; z < chunkSize; z++)
+            generateXZSides<chunkSize>(false, z * chunkSize, sides);
     }
-    if (chunkX < HORIZONTAL_CHUNKS - 1) {
-        uint32_t otherStartXZIndex = (chunkX + 1 + chunkZ * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE;
-        for (int z = 0; z < CHUNK_SIZE; z++)
-            generateXZSides(otherStartXZIndex + z * CHUNK_SIZE, true, z * CHUNK_SIZE, startY, IDs, IDIndexes, sides);
+    if ((int)chunkX < chunks.world.horizontalChunks - 1) {
+        const PalettedChunk& other = chunks.chunk(chunkX + 1, chunkY, chunkZ);
+        if (!other.empty()) {
+            for (int z = 0; z < chunkSize; z++) {
+                for (int y = 0; y < chunkSize; y++) sides[y + z * chunkSize].y = other.solidRow(y, z) & 1;
+            }
+        }
     }
     else {
-        for (int z = 0; z < CHUNK_SIZE; z++)
-            generateXZSides(true, z * CHUNK_SIZE, sides);
+        for (int z = 0; z < chunkSize; z++)
+            generateXZSides<chunkSize>(true, z * chunkSize, sides);
     }
     if (chunkZ > 0) {
-        uint32_t otherStartXZIndex = (chunkX + (chunkZ - 1) * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE;
-        for (int x = 0; x < CHUNK_SIZE; x++)
-            generateXZSides(otherStartXZIndex + x + (CHUNK_SIZE - 1) * CHUNK_SIZE, false, x * CHUNK_SIZE + 2 * CHUNK_SIZE * CHUNK_SIZE, startY, IDs, IDIndexes, sides);
+        const PalettedChunk& other = chunks.chunk(chunkX, chunkY, chunkZ - 1);
+        if (!other.empty()) {
+            for (int y = 0; y < chunkSize; y++) {
+                Row row = other.solidRow(y, chunkSize - 1);
+                for (; row != 0; row &= row - 1) sides[y + __builtin_ctzll(row) * chunkSize + 2 * chunkSize * chunkSize].x = true;
+            }
+        }
     }
     else {
-        for (int x = 0; x < CHUNK_SIZE; x++)
-            generateXZSides(false, x * CHUNK_SIZE + 2 * CHUNK_SIZE * CHUNK_SIZE, sides);
+        for (int x = 0; x < chunkSize; x++)
+            generateXZSides<chunkSize>(false, x * chunkSize + 2 * chunkSize * chunkSize, sides);
     }
-    if (chunkZ < HORIZONTAL_CHUNKS - 1) {
-        uint32_t otherStartXZIndex = (chunkX + (chunkZ + 1) * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE;
-        for (int x = 0; x < CHUNK_SIZE; x++)
-            generateXZSides(otherStartXZIndex + x, true, x * CHUNK_SIZE + 2 * CHUNK_SIZE * CHUNK_SIZE, startY, IDs, IDIndexes, sides);
+    if ((int)chunkZ < chunks.world.horizontalChunks - 1) {
+        const PalettedChunk& other = chunks.chunk(chunkX, chunkY, chunkZ + 1);
+        if (!other.empty()) {
+            for (int y = 0; y < chunkSize; y++) {
+                Row row = other.solidRow(y, 0);
+                for (; row != 0; row &= row - 1) sides[y + __builtin_ctzll(row) * chunkSize + 2 * chunkSize * chunkSize].y = true;
+            }
+        }
     }
     else {
-        for (int x = 0; x < CHUNK_SIZE; x++)
-            generateXZSides(true, x * CHUNK_SIZE + 2 * CHUNK_SIZE * CHUNK_SIZE, sides);
+        for (int x = 0; x < chunkSize; x++)
+            generateXZSides<chunkSize>(true, x * chunkSize + 2 * chunkSize * chunkSize, sides);
     }
 }
 
 
-// Generate side row at (x, z)
-void generateXZSides(uint32_t xzIndex, bool after, int startIndex, int startY, int* IDs, uint32_t* IDIndexes, bvec2* sides) {
-    uint32_t i = IDIndexes[xzIndex];
-    for (int y = 0; y < CHUNK_SIZE; y++) {
-        if (y == IDs[i] - startY) {
-            sides[startIndex + y] = bvec2(after ? sides[startIndex + y].x : true, after ? true : sides[startIndex + y].y);
-            i += 2;
-            if (i >= IDIndexes[xzIndex + 1]) return;
+template<int chunkSize> int getID(ivec3 pos, uint32_t chunkX, uint32_t chunkZ, int startY, const PalettedChunks& chunks, const uint8_t* chunkIDs) {
+    return chunks.chunk(chunkX, startY / chunkSize, chunkZ).getID(pos.x, pos.y, pos.z);
+}
+
+
+// Find the y range of a chunk column (same as the compact format: down to the lowest top around each column) and the IDs it contains
+template<int chunkSize> void findChunkBlocks(uint32_t chunkX, uint32_t chunkZ, const HeightMap& heightMap, int& minY, int& maxY, bool* containedIDs) {
+    int horizontalSize = heightMap.world.horizontalSize;
+    minY = heightMap.world.verticalSize;
+    maxY = 0;
+    for (int z = chunkZ * chunkSize; z < (int)(chunkZ + 1) * chunkSize; z++) {
+        const uint16_t* heights = heightMap.heights.data() + z * horizontalSize;
+        for (int x = chunkX * chunkSize; x < (int)(chunkX + 1) * chunkSize; x++) {
+            int height = heights[x];
+            int bottom = height - 1;
+            if (x > 0) bottom = std::min(bottom, (int)heights[x - 1]);
+            if (x < horizontalSize - 1) bottom = std::min(bottom, (int)heights[x + 1]);
+            if (z > 0) bottom = std::min(bottom, (int)heights[x - horizontalSize]);
+            if (z < horizontalSize - 1) bottom = std::min(bottom, (int)heights[x + horizontalSize]);
+            if (bottom < minY) minY = bottom;
+            if (height > maxY) maxY = height;
+            containedIDs[heightMap.ids[x + z * horizontalSize]] = true;
         }
     }
 }
 
-// Generate filled side row at (x, z)
-void generateXZSides(bool after, int startIndex, bvec2* sides) {
-    for (int y = 0; y < CHUNK_SIZE; y++) {
-        sides[startIndex + y] = bvec2(after ? sides[startIndex + y].x : true, after ? true : sides[startIndex + y].y);
+
+// Add the faces of the highest blocks of a chunk to planes (same planes as generateBinaryPlanes() for the same blocks, the chunks have the same y start).
+// Blocks below the highest block are invisible, so each column has a top face and a side face towards each lower column around it
+// (columns outside the world are solid).
+template<int chunkSize> void generateHeightMapPlanes(uint32_t chunkX, uint32_t chunkZ, int startY, const HeightMap& heightMap, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* idToIndex, int idCount) {
+    typedef ChunkRow<chunkSize> Row;
+    int horizontalSize = heightMap.world.horizontalSize;
+    int startX = chunkX * chunkSize;
+    int startZ = chunkZ * chunkSize;
+    auto addFace = [&](CubeNormal normal, int idIndex, int depth, int row, int bit) {
+        int plane = depth + idIndex * chunkSize + (int)normal * chunkSize * idCount;
+        planes[row + plane * chunkSize] |= (Row)1 << bit;
+        touchedPlanes[plane] = true;
+    };
+    for (int z = 0; z < chunkSize; z++) {
+        int index = startX + (startZ + z) * horizontalSize;
+        const uint16_t* heights = heightMap.heights.data() + index;
+        const uint8_t* ids = heightMap.ids.data() + index;
+        bool before = startZ + z > 0;
+        bool after = startZ + z < horizontalSize - 1;
+        for (int x = 0; x < chunkSize; x++) {
+            int height = heights[x];
+            int y = height - startY;
+            if (y < 0 || y >= chunkSize || ids[x] == 0) continue; // Not in this chunk or invisible
+            int idIndex = idToIndex[ids[x]];
+            addFace(CubeNormal::yPositive, idIndex, y, z, x);
+            if (startX + x < horizontalSize - 1 && heights[x + 1] < height) addFace(CubeNormal::xPositive, idIndex, x, z, y);
+            if (startX + x > 0 && heights[x - 1] < height) addFace(CubeNormal::xNegative, idIndex, x, z, y);
+            if (after && heights[x + horizontalSize] < height) addFace(CubeNormal::zPositive, idIndex, z, x, y);
+            if (before && heights[x - horizontalSize] < height) addFace(CubeNormal::zNegative, idIndex, z, x, y);
+        }
     }
 }
 
 
-// planes: 64 bits rows containing 1 if the face must be rendered, 0 otherwise
+// planes: bit rows containing 1 if the face must be rendered, 0 otherwise
 // planes contains chunkSize (rows in one plane) * chunkSize (planes in one direction) * nbrIDs * 6 (x+, z+, y+, x-, z-, y-)
-void generateBinaryPlanes(uint32_t startXZIndex, int startY, int* IDs, uint32_t* IDIndexes, uint64_t* rows, bvec2* sides, uint64_t* planes, int* idToIndex, int idCount) {
-    generateAxisBinaryPlanes(0, startXZIndex, startY, IDs, IDIndexes, rows, sides, planes, idToIndex, idCount);
-    generateAxisBinaryPlanes(1, startXZIndex, startY, IDs, IDIndexes, rows, sides, planes, idToIndex, idCount);
-    generateAxisBinaryPlanes(2, startXZIndex, startY, IDs, IDIndexes, rows, sides, planes, idToIndex, idCount);
+template<int chunkSize, typename Blocks> void generateBinaryPlanes(uint32_t chunkX, uint32_t chunkZ, int startY, const Blocks& blocks, ChunkRow<chunkSize>* rows, bvec2* sides, const uint8_t* chunkIDs, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* idToIndex, int idCount) {
+    generateAxisBinaryPlanes<chunkSize, 0>(chunkX, chunkZ, startY, blocks, rows, sides, chunkIDs, planes, touchedPlanes, idToIndex, idCount);
+    generateAxisBinaryPlanes<chunkSize, 1>(chunkX, chunkZ, startY, blocks, rows, sides, chunkIDs, planes, touchedPlanes, idToIndex, idCount);
+    generateAxisBinaryPlanes<chunkSize, 2>(chunkX, chunkZ, startY, blocks, rows, sides, chunkIDs, planes, touchedPlanes, idToIndex, idCount);
 }
 
 
-// Generate binary planes for one axis
-void generateAxisBinaryPlanes(uint32_t axis, uint32_t startXZIndex, int startY, int* IDs, uint32_t* IDIndexes, uint64_t* rows, bvec2* sides, uint64_t* planes, int* idToIndex, int idCount) {
-    ivec3 beforeX = ivec3(0, startY, 0);
-    for (int y = 0; y < CHUNK_SIZE; y++) { // Iter plane rows
+// Generate binary planes for one axis (known at compile time, so that positions are updated without axis arithmetic)
+template<int chunkSize, uint32_t axis, typename Blocks> void generateAxisBinaryPlanes(uint32_t chunkX, uint32_t chunkZ, int startY, const Blocks& blocks, ChunkRow<chunkSize>* rows, bvec2* sides, const uint8_t* chunkIDs, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* idToIndex, int idCount) {
+    typedef ChunkRow<chunkSize> Row;
+    ivec3 beforeX = ivec3(0, 0, 0);
+    for (int y = 0; y < chunkSize; y++) { // Iter plane rows
         ivec3 pos = beforeX;
-        for (int x = 0; x < CHUNK_SIZE; x++) { // Iter plane columns
-            uint64_t row = rows[x + y * CHUNK_SIZE + axis * CHUNK_SIZE * CHUNK_SIZE];
-            bvec2 side = sides[x + y * CHUNK_SIZE + axis * CHUNK_SIZE * CHUNK_SIZE];
+        for (int x = 0; x < chunkSize; x++) { // Iter plane columns
+            Row row = rows[x + y * chunkSize + axis * chunkSize * chunkSize];
+            bvec2 side = sides[x + y * chunkSize + axis * chunkSize * chunkSize];
 
             // Find faces to render in positive direction and add them to planes
-            uint64_t shiftedRow = row >> 1;
-            if (side.y) shiftedRow |= (uint64_t)1 << 63;
-            uint64_t faceRow = row & ~shiftedRow;
+            Row shiftedRow = row >> 1;
+            if (side.y) shiftedRow |= (Row)1 << (chunkSize - 1);
+            Row faceRow = row & ~shiftedRow;
             while (faceRow != 0) {
                 int depth = __builtin_ctzll(faceRow);
-                faceRow &= ~((uint64_t)1 << depth);
+                faceRow &= ~((Row)1 << depth);
                 ivec3 posDepth = pos;
                 posDepth[axis] += depth;
-                int id = getID(posDepth, startXZIndex, IDs, IDIndexes);
+                int id = getID<chunkSize>(posDepth, chunkX, chunkZ, startY, blocks, chunkIDs);
                 if (id != 0) {
-                    planes[y + depth * CHUNK_SIZE + idToIndex[id] * CHUNK_SIZE * CHUNK_SIZE + 2 * axis * CHUNK_SIZE * CHUNK_SIZE * idCount]
-                        |= (uint64_t)1 << x;
+                    int plane = depth + idToIndex[id] * chunkSize + 2 * axis * chunkSize * idCount;
+                    planes[y + plane * chunkSize] |= (Row)1 << x;
+                    touchedPlanes[plane] = true;
                 }
             }
 
@@ -216,13 +868,14 @@ void generateAxisBinaryPlanes(uint32_t axis, uint32_t startXZIndex, int startY,
             faceRow = row & ~shiftedRow;
             while (faceRow != 0) {
                 int depth = __builtin_ctzll(faceRow);
-                faceRow &= ~((uint64_t)1 << depth);
+                faceRow &= ~((Row)1 << depth);
                 ivec3 posDepth = pos;
                 posDepth[axis] += depth;
-                int id = getID(posDepth, startXZIndex, IDs, IDIndexes);
+                int id = getID<chunkSize>(posDepth, chunkX, chunkZ, startY, blocks, chunkIDs);
                 if (id != 0) {
-                    planes[y + depth * CHUNK_SIZE + idToIndex[id] * CHUNK_SIZE * CHUNK_SIZE + (2 * axis + 1) * CHUNK_SIZE * CHUNK_SIZE * idCount]
-                        |= (uint64_t)1 << x;
+                    int plane = depth + idToIndex[id] * chunkSize + (2 * axis + 1) * chunkSize * idCount;
+                    planes[y + plane * chunkSize] |= (Row)1 << x;
+                    touchedPlanes[plane] = true;
                 }
             }
 
@@ -233,67 +886,288 @@ void generateAxisBinaryPlanes(uint32_t axis, uint32_t startXZIndex, int startY,
 }
 
 
-int getID(ivec3 pos, int startXZIndex, int* IDs, uint32_t* IDIndexes) {
-    for (uint32_t i = IDIndexes[startXZIndex + pos.x + pos.z * CHUNK_SIZE]; i < IDIndexes[startXZIndex + pos.x + pos.z * CHUNK_SIZE + 1]; i += 2) {
-        if (IDs[i] == pos.y) return IDs[i + 1];
-    }
-    return 0; // Shouldn't happen
-}
-
-
-void generateOptimizedMesh(uint32_t chunkX, uint32_t chunkZ, int startY, uint64_t* planes, int* indexToId, int idCount, vector<VoxelMesh>& meshes, vector<Square>& squares) {
-    generateNormalOptimizedMesh(CubeNormal::xPositive, chunkX, chunkZ, startY, planes, indexToId, idCount, meshes, squares);
-    generateNormalOptimizedMesh(CubeNormal::xNegative, chunkX, chunkZ, startY, planes, indexToId, idCount, meshes, squares);
-    generateNormalOptimizedMesh(CubeNormal::yPositive, chunkX, chunkZ, startY, planes, indexToId, idCount, meshes, squares);
-    generateNormalOptimizedMesh(CubeNormal::yNegative, chunkX, chunkZ, startY, planes, indexToId, idCount, meshes, squares);
-    generateNormalOptimizedMesh(CubeNormal::zPositive, chunkX, chunkZ, startY, planes, indexToId, idCount, meshes, squares);
-    generateNormalOptimizedMesh(CubeNormal::zNegative, chunkX, chunkZ, startY, planes, indexToId, idCount, meshes, squares);
+template<int chunkSize> void generateOptimizedMesh(uint32_t chunkX, uint32_t chunkZ, int startY, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* indexToId, int idCount, vector<VoxelMesh>& meshes, vector<Square>& squares) {
+    generateNormalOptimizedMesh<chunkSize, CubeNormal::xPositive>(chunkX, chunkZ, startY, planes, touchedPlanes, indexToId, idCount, meshes, squares);
+    generateNormalOptimizedMesh<chunkSize, CubeNormal::xNegative>(chunkX, chunkZ, startY, planes, touchedPlanes, indexToId, idCount, meshes, squares);
+    generateNormalOptimizedMesh<chunkSize, CubeNormal::yPositive>(chunkX, chunkZ, startY, planes, touchedPlanes, indexToId, idCount, meshes, squares);
+    generateNormalOptimizedMesh<chunkSize, CubeNormal::yNegative>(chunkX, chunkZ, startY, planes, touchedPlanes, indexToId, idCount, meshes, squares);
+    generateNormalOptimizedMesh<chunkSize, CubeNormal::zPositive>(chunkX, chunkZ, startY, planes, touchedPlanes, indexToId, idCount, meshes, squares);
+    generateNormalOptimizedMesh<chunkSize, CubeNormal::zNegative>(chunkX, chunkZ, startY, planes, touchedPlanes, indexToId, idCount, meshes, squares);
 }
 
 
-void generateNormalOptimizedMesh(CubeNormal normal, uint32_t chunkX, uint32_t chunkZ, int startY, uint64_t* planes, int* indexToId, int idCount, vector<VoxelMesh>& meshes, vector<Square>& squares) {
-    VoxelMesh mesh = VoxelMesh(normal, chunkX, chunkZ, startY);
+template<int chunkSize, CubeNormal normal> void generateNormalOptimizedMesh(uint32_t chunkX, uint32_t chunkZ, int startY, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* indexToId, int idCount, vector<VoxelMesh>& meshes, vector<Square>& squares) {
+    VoxelMesh mesh = VoxelMesh(normal, chunkX, chunkZ, startY, chunkSize);
     for (int i = 0; i < idCount; i++) {
-        for (int depth = 0; depth < CHUNK_SIZE; depth++) {
-            generateOptimizedPlane(normal, depth, i, mesh, planes, indexToId, idCount, squares);
+        for (int depth = 0; depth < chunkSize; depth++) {
+            generateOptimizedPlane<chunkSize, normal>(depth, i, mesh, planes, touchedPlanes, indexToId, idCount, squares);
         }
     }
     if (mesh.squaresCount != 0) meshes.push_back(mesh);
 }
 
 
-void generateOptimizedPlane(CubeNormal normal, int depth, int idIndex, VoxelMesh& mesh, uint64_t* planes, int* indexToId, int idCount, vector<Square>& squares) {
-    int startIndex =
-        (int)normal * CHUNK_SIZE * CHUNK_SIZE * idCount
-        + idIndex * CHUNK_SIZE * CHUNK_SIZE
-        + depth * CHUNK_SIZE;
-    for (int y = 0; y < CHUNK_SIZE; y++) { // Iter plane rows
-        uint64_t row = planes[startIndex + y];
-        int x = row == 0 ? 64 : __builtin_ctzll(row);
+template<int chunkSize, CubeNormal normal> void generateOptimizedPlane(int depth, int idIndex, VoxelMesh& mesh, ChunkRow<chunkSize>* planes, bool* touchedPlanes, int* indexToId, int idCount, vector<Square>& squares) {
+    typedef ChunkRow<chunkSize> Row;
+    int plane = (int)normal * chunkSize * idCount + idIndex * chunkSize + depth;
+    if (!touchedPlanes[plane]) return;
+    int startIndex = plane * chunkSize;
+    for (int y = 0; y < chunkSize; y++) { // Iter plane rows
+        Row row = planes[startIndex + y];
+        int x = row == 0 ? chunkSize : __builtin_ctzll(row);
         row >>= x;
-        while (x < CHUNK_SIZE) {
+        while (x < chunkSize) {
             // Expand in x
-            int width = ~row == 0 ? 64 : __builtin_ctzll(~row);
-            uint64_t checkMask = (row << (64 - width)) >> (64 - width - x);
-            uint64_t deleteMask = ~checkMask;
+            int width = ~row == 0 ? chunkSize : __builtin_ctzll(~row);
+            Row checkMask = (row << (chunkSize - width)) >> (chunkSize - width - x);
+            Row deleteMask = ~checkMask;
             row >>= width;
 
             // Expand in y
             int height = 1;
-            while (y + height < CHUNK_SIZE) {
+            while (y + height < chunkSize) {
                 if ((planes[startIndex + y + height] & checkMask) != checkMask) break;
                 planes[startIndex + y + height] &= deleteMask;
                 height++;
             }
 
             // Add the rectangle
-            squares.push_back(mesh.add(x, y, depth, width, height, indexToId[idIndex]));
+            squares.push_back(mesh.add<normal>(x, y, depth, width, height, indexToId[idIndex]));
             x += width;
 
             // Skip zeros
-            int skip = row == 0 ? 64 : __builtin_ctzll(row);
+            int skip = row == 0 ? chunkSize : __builtin_ctzll(row);
             x += skip;
             row >>= skip;
         }
     }
-}
\ No newline at end of file
+
+    // Clear the plane for the next chunk
+    fill(planes + startIndex, planes + startIndex + chunkSize, 0);
+    touchedPlanes[plane] = false;
+}
+
+
+
+// Start of a level of detail in the buffers of a chunk column (levels one after the other, each with room for all chunks of a chunk column)
+// for buffers with an element for each cell (3 dimensions) or for each row of cells (2 dimensions)
+template<int chunkSize, int dimensions> uint32_t lodGridStart(uint32_t lod, int verticalChunks) {
+    uint32_t start = 0;
+    for (uint32_t level = 1; level < lod; level++) {
+        uint32_t size = chunkSize >> level;
+        start += (dimensions == 3 ? size * size * size : size * size) * verticalChunks;
+    }
+    return start;
+}
+
+
+// Downsample the faces of a chunk (before they are meshed) to all levels of detail.
+// Each face votes for its ID in the cell of the block it belongs to.
+template<int chunkSize> void downsamplePlanes(int chunkY, int verticalChunks, const ChunkRow<chunkSize>* planes, const bool* touchedPlanes, const int* indexToId, int idCount, const LodBuffers& lod) {
+    constexpr int size = chunkSize / 2;
+    LodCell* cells = lod.cells + chunkY * size * size * size;
+    uint32_t* rows = lod.rows + chunkY * size * size * lodRowCount;
+    fill(rows, rows + size * size * lodRowCount, 0);
+    downsampleNormalPlanes<chunkSize, CubeNormal::xPositive>(planes, touchedPlanes, indexToId, idCount, cells, rows);
+    downsampleNormalPlanes<chunkSize, CubeNormal::xNegative>(planes, touchedPlanes, indexToId, idCount, cells, rows);
+    downsampleNormalPlanes<chunkSize, CubeNormal::yPositive>(planes, touchedPlanes, indexToId, idCount, cells, rows);
+    downsampleNormalPlanes<chunkSize, CubeNormal::yNegative>(planes, touchedPlanes, indexToId, idCount, cells, rows);
+    downsampleNormalPlanes<chunkSize, CubeNormal::zPositive>(planes, touchedPlanes, indexToId, idCount, cells, rows);
+    downsampleNormalPlanes<chunkSize, CubeNormal::zNegative>(planes, touchedPlanes, indexToId, idCount, cells, rows);
+
+    // Coarser levels from the finer ones
+    for (uint32_t level = 2; level <= lodCount; level++) {
+        int fineSize = chunkSize >> (level - 1);
+        int coarseSize = chunkSize >> level;
+        downsampleCells(
+            fineSize,
+            lod.cells + lodGridStart<chunkSize, 3>(level - 1, verticalChunks) + chunkY * fineSize * fineSize * fineSize,
+            lod.rows + (lodGridStart<chunkSize, 2>(level - 1, verticalChunks) + chunkY * fineSize * fineSize) * lodRowCount,
+            lod.cells + lodGridStart<chunkSize, 3>(level, verticalChunks) + chunkY * coarseSize * coarseSize * coarseSize,
+            lod.rows + (lodGridStart<chunkSize, 2>(level, verticalChunks) + chunkY * coarseSize * coarseSize) * lodRowCount
+        );
+    }
+}
+
+
+// Two rows of a plane are downsampled at once, the faces of a cell in the rows vote together
+template<int chunkSize, CubeNormal normal> void downsampleNormalPlanes(const ChunkRow<chunkSize>* planes, const bool* touchedPlanes, const int* indexToId, int idCount, LodCell* cells, uint32_t* rows) {
+    typedef ChunkRow<chunkSize> Row;
+    constexpr uint32_t depthAxis = axis(normal);
+    constexpr int size = chunkSize / 2;
+    constexpr Row evenBits = (Row)0x5555555555555555;
+    for (int idIndex = 0; idIndex < idCount; idIndex++) {
+        for (int depth = 0; depth < chunkSize; depth++) {
+            int plane = (int)normal * chunkSize * idCount + idIndex * chunkSize + depth;
+            if (!touchedPlanes[plane]) continue;
+            for (int y = 0; y < chunkSize; y += 2) {
+                Row row0 = planes[plane * chunkSize + y];
+                Row row1 = planes[plane * chunkSize + y + 1];
+                Row both = row0 | row1;
+                for (Row pairs = (both | (both >> 1)) & evenBits; pairs != 0; pairs &= pairs - 1) { // Bit 2x : cell x has faces
+                    int x = __builtin_ctzll(pairs);
+                    ivec3 pos;
+                    pos[depthAxis] = depth >> 1;
+                    pos[widthAxis(depthAxis)] = x >> 1;
+                    pos[heightAxis(depthAxis)] = y >> 1;
+                    uint32_t* cellRows = rows + (pos.z + pos.y * size) * lodRowCount;
+                    uint32_t bit = 1u << pos.x;
+                    LodCell& cell = cells[pos.x + pos.z * size + pos.y * size * size];
+                    if ((cellRows[6] & bit) == 0) { // First faces of the cell
+                        cellRows[6] |= bit;
+                        cell = LodCell { 0, 0 };
+                    }
+                    cellRows[(int)normal] |= bit;
+                    voteCell(cell, indexToId[idIndex], __builtin_popcountll((row0 >> x) & 3) + __builtin_popcountll((row1 >> x) & 3));
+                }
+            }
+        }
+    }
+}
+
+
+// Downsample a chunk of cells to cells twice as large: a cell has the faces of its cells, each of its cells votes for its ID with its votes
+void downsampleCells(int size, const LodCell* cells, const uint32_t* rows, LodCell* coarseCells, uint32_t* coarseRows) {
+    int coarseSize = size / 2;
+    for (int y = 0; y < coarseSize; y++) {
+        for (int z = 0; z < coarseSize; z++) {
+            uint32_t* coarseCellRows = coarseRows + (z + y * coarseSize) * lodRowCount;
+            for (int i = 0; i < lodRowCount; i++) {
+                uint32_t row = 0;
+                for (int j = 0; j < 4; j++) row |= rows[((2 * z + (j & 1)) + (2 * y + (j >> 1)) * size) * lodRowCount + i];
+                coarseCellRows[i] = downsampleRow(row);
+            }
+            for (uint32_t row = coarseCellRows[6]; row != 0; row &= row - 1) coarseCells[__builtin_ctz(row) + (z + y * coarseSize) * coarseSize] = LodCell { 0, 0 };
+        }
+    }
+    for (int y = 0; y < size; y++) {
+        for (int z = 0; z < size; z++) {
+            for (uint32_t row = rows[(z + y * size) * lodRowCount + 6]; row != 0; row &= row - 1) {
+                int x = __builtin_ctz(row);
+                const LodCell& cell = cells[x + (z + y * size) * size];
+                voteCell(coarseCells[(x >> 1) + ((z >> 1) + (y >> 1) * coarseSize) * coarseSize], cell.id, cell.votes);
+            }
+        }
+    }
+}
+
+
+// Bit x of the downsampled row: bit 2x or 2x + 1 of the row
+uint32_t downsampleRow(uint32_t row) {
+    row = (row | (row >> 1)) & 0x55555555;
+    row = (row | (row >> 1)) & 0x33333333;
+    row = (row | (row >> 2)) & 0x0f0f0f0f;
+    row = (row | (row >> 4)) & 0x00ff00ff;
+    return (row | (row >> 8)) & 0x0000ffff;
+}
+
+
+// Boyer-Moore majority vote: the ID of the cell is the majority ID of the votes if there is one
+// (an ID is only replaced by a visible ID, so cells with faces always have a visible ID)
+void voteCell(LodCell& cell, uint8_t id, uint16_t votes) {
+    if (cell.id == id) cell.votes += votes;
+    else if (votes > cell.votes || cell.id == 0) {
+        cell.votes = votes - cell.votes;
+        cell.id = id;
+    }
+    else cell.votes -= votes;
+}
+
+
+// Mesh the downsampled chunks of a chunk column, for each level of detail.
+// A cell has a face if it contains faces with the normal and the next cell has no faces (cells above and below the chunk column have no faces).
+// Cells on the sides of the chunk column have a face on the side whatever faces they contain (skirt, the next chunk column can be
+// at another level of detail): cells contain all faces of their blocks, so it covers the gap between the surfaces of both chunk columns.
+// Sides on the border of the world have no faces, like full resolution meshes (the outside of the world is solid).
+template<int chunkSize> void generateLodMesh(uint32_t chunkX, uint32_t chunkZ, int xzStartY, int chunkCount, const WorldConfig& world, const LodBuffers& lod, vector<VoxelMesh>& meshes, vector<Square>& squares) {
+    bool xNegativeSide = chunkX > 0; // Whether the side is inside the world
+    bool xPositiveSide = chunkX + 1 < (uint32_t)world.horizontalChunks;
+    bool zNegativeSide = chunkZ > 0;
+    bool zPositiveSide = chunkZ + 1 < (uint32_t)world.horizontalChunks;
+    for (uint32_t level = 1; level <= lodCount; level++) {
+        int size = chunkSize >> level;
+        int columnSize = chunkCount * size;
+        uint32_t last = 1u << (size - 1);
+        uint32_t xNegativeCells = xNegativeSide ? ~0u : ~1u; // Cells that can have a face with the normal
+        uint32_t xPositiveCells = xPositiveSide ? ~0u : ~last;
+        const LodCell* cells = lod.cells + lodGridStart<chunkSize, 3>(level, world.verticalChunks);
+        const uint32_t* rows = lod.rows + lodGridStart<chunkSize, 2>(level, world.verticalChunks) * lodRowCount;
+        for (int chunkY = 0; chunkY < chunkCount; chunkY++) {
+            // Faces of the cells of the chunk
+            for (int y = 0; y < size; y++) {
+                int columnY = y + chunkY * size;
+                for (int z = 0; z < size; z++) {
+                    const uint32_t* cellRows = rows + (z + columnY * size) * lodRowCount;
+                    uint32_t row = cellRows[6];
+                    if (row == 0) continue;
+                    uint32_t above = columnY + 1 < columnSize ? rows[(z + (columnY + 1) * size) * lodRowCount + 6] : 0;
+                    uint32_t below = columnY > 0 ? rows[(z + (columnY - 1) * size) * lodRowCount + 6] : 0;
+                    const LodCell* rowCells = cells + (z + columnY * size) * size;
+                    addLodFaces<CubeNormal::xPositive>(((cellRows[0] & ~(row >> 1)) | (row & last)) & xPositiveCells, y, z, size, rowCells, lod.planeIDs, lod.planeRows);
+                    addLodFaces<CubeNormal::xNegative>(((cellRows[1] & ~(row << 1)) | (row & 1)) & xNegativeCells, y, z, size, rowCells, lod.planeIDs, lod.planeRows);
+                    addLodFaces<CubeNormal::yPositive>(cellRows[2] & ~above, y, z, size, rowCells, lod.planeIDs, lod.planeRows);
+                    addLodFaces<CubeNormal::yNegative>(cellRows[3] & ~below, y, z, size, rowCells, lod.planeIDs, lod.planeRows);
+                    addLodFaces<CubeNormal::zPositive>(z + 1 < size ? cellRows[4] & ~cellRows[lodRowCount + 6] : (zPositiveSide ? row : 0), y, z, size, rowCells, lod.planeIDs, lod.planeRows);
+                    addLodFaces<CubeNormal::zNegative>(z > 0 ? cellRows[5] & ~cellRows[6 - lodRowCount] : (zNegativeSide ? row : 0), y, z, size, rowCells, lod.planeIDs, lod.planeRows);
+                }
+            }
+
+            // Greedy meshing
+            int startY = xzStartY + chunkY * chunkSize;
+            generateLodNormalMesh<chunkSize, CubeNormal::xPositive>(chunkX, chunkZ, startY, level, lod.planeIDs, lod.planeRows, meshes, squares);
+            generateLodNormalMesh<chunkSize, CubeNormal::xNegative>(chunkX, chunkZ, startY, level, lod.planeIDs, lod.planeRows, meshes, squares);
+            generateLodNormalMesh<chunkSize, CubeNormal::yPositive>(chunkX, chunkZ, startY, level, lod.planeIDs, lod.planeRows, meshes, squares);
+            generateLodNormalMesh<chunkSize, CubeNormal::yNegative>(chunkX, chunkZ, startY, level, lod.planeIDs, lod.planeRows, meshes, squares);
+            generateLodNormalMesh<chunkSize, CubeNormal::zPositive>(chunkX, chunkZ, startY, level, lod.planeIDs, lod.planeRows, meshes, squares);
+            generateLodNormalMesh<chunkSize, CubeNormal::zNegative>(chunkX, chunkZ, startY, level, lod.planeIDs, lod.planeRows, meshes, squares);
+        }
+    }
+}
+
+
+// Add faces of a row of cells (bit x : cell x has a face) to the planes of the downsampled chunk
+template<CubeNormal normal> void addLodFaces(uint32_t faces, int y, int z, int size, const LodCell* rowCells, uint8_t* planeIDs, uint32_t* planeRows) {
+    constexpr uint32_t depthAxis = axis(normal);
+    for (; faces != 0; faces &= faces - 1) {
+        ivec3 pos = ivec3(__builtin_ctz(faces), y, z);
+        int row = ((int)normal * size + pos[depthAxis]) * size + pos[heightAxis(depthAxis)];
+        int x = pos[widthAxis(depthAxis)];
+        planeIDs[x + row * size] = rowCells[pos.x].id;
+        planeRows[row] |= 1u << x;
+    }
+}
+
+
+template<int chunkSize, CubeNormal normal> void generateLodNormalMesh(uint32_t chunkX, uint32_t chunkZ, int startY, uint32_t lod, uint8_t* planeIDs, uint32_t* planeRows, vector<VoxelMesh>& meshes, vector<Square>& squares) {
+    int size = chunkSize >> lod;
+    VoxelMesh mesh = VoxelMesh(normal, chunkX, chunkZ, startY, chunkSize, lod);
+    for (int depth = 0; depth < size; depth++) {
+        int startRow = ((int)normal * size + depth) * size;
+        for (int y = 0; y < size; y++) {
+            uint32_t* rows = planeRows + startRow;
+            const uint8_t* ids = planeIDs + (startRow + y) * size;
+            while (rows[y] != 0) {
+                // Expand in x (faces with the same ID)
+                int x = __builtin_ctz(rows[y]);
+                uint8_t id = ids[x];
+                int width = 1;
+                while (x + width < size && ((rows[y] >> (x + width)) & 1) != 0 && ids[x + width] == id) width++;
+                uint32_t mask = (uint32_t)(((1ull << width) - 1) << x);
+                rows[y] &= ~mask;
+
+                // Expand in y
+                int height = 1;
+                while (y + height < size && (rows[y + height] & mask) == mask) {
+                    const uint8_t* rowIDs = ids + height * size;
+                    if (!all_of(rowIDs + x, rowIDs + x + width, [id](uint8_t rowID) { return rowID == id; })) break;
+                    rows[y + height] &= ~mask;
+                    height++;
+                }
+
+                // Add the rectangle
+                squares.push_back(mesh.add<normal>(x, y, depth, width, height, id));
+            }
+        }
+    }
+    if (mesh.squaresCount != 0) meshes.push_back(mesh);
+}
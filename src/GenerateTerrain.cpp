@@ -1,70 +1,319 @@
 #include "GenerateTerrain.hpp"
 
 #include <cstdint>
-#include <cmath>
+#include <algorithm>
 #include <vector>
 
-#include "Constants.hpp"
+#include "Parallel.hpp"
+#include "TerrainGenerator.hpp"
+#include "DensityGenerator.hpp"
+#include "CompactColumns.hpp"
+#include "HeightMap.hpp"
+#include "WorldConfig.hpp"
 
 using namespace std;
 
-void generateHeightMap(int* heightMap, int* ids);
-void generateIDs(int* heightMap, int* ids, vector<int>& IDs, uint32_t* IDIndexes);
+// Heights and IDs are only stored for a band of rows at a time.
+// Band containing chunk rows [startChunkZ, endChunkZ[ : rows [startChunkZ * chunkSize - 1, endChunkZ * chunkSize] (1 row margin on each side)
+// Index of (x, z) in the band: x + (z - startChunkZ * chunkSize + 1) * horizontalSize
 
+void generateHeightMap(const TerrainGenerator& generator, const WorldConfig& world, int startChunkZ, int endChunkZ, int* heightMap, int* ids, uint32_t threadCount);
+void countIDs(const WorldConfig& world, int startChunkZ, int endChunkZ, int* heightMap, uint32_t* IDIndexes, uint32_t* chunkSizes, uint32_t threadCount);
+void generateIDs(const WorldConfig& world, int startChunkZ, int endChunkZ, int* heightMap, int* ids, int* IDs, uint32_t* IDIndexes, uint32_t* chunkStarts, uint32_t threadCount);
+void generateColumns(const WorldConfig& world, int startChunkZ, int endChunkZ, int* heightMap, int* ids, CompactColumns& columns, uint32_t threadCount);
+int minSurroundingY(const WorldConfig& world, int startZ, int* heightMap, int x, int z);
+void generateSolidBlocks(const DensityGenerator& generator, const WorldConfig& world, int chunkX, int chunkZ, uint64_t* solid);
+void findVisibleBlocks(const WorldConfig& world, uint64_t* solid, uint64_t* visible);
+void generateDensityColumns(const WorldConfig& world, int chunkX, int chunkZ, uint64_t* solid, uint64_t* visible, vector<uint16_t>& ys, vector<uint8_t>& ids, CompactColumns& columns);
 
-static constexpr int amplitude = 80;
-static constexpr int blockPeriod = 500;
-static constexpr int idHeight = 50;
+// 3D terrain is generated one chunk at a time, with a margin of 2 columns on each side:
+// a stored block needs its neighbours to know if it is visible, and invisible blocks need the visibility of their neighbours.
+// Column (x, z) of the chunk with its margin (x and z from -2 to chunkSize + 1): solid[((x + 2) + (z + 2) * (chunkSize + 4)) * wordCount]
+static constexpr int densityMargin = 2;
 
 
-void generateTerrain(vector<int>& IDs, uint32_t* IDIndexes) {
-    int* heightMap = new int[HORIZONTAL_SIZE * HORIZONTAL_SIZE];
-    int* ids = new int[HORIZONTAL_SIZE * HORIZONTAL_SIZE];
-    generateHeightMap(heightMap, ids);
-    generateIDs(heightMap, ids, IDs, IDIndexes);
+void generateTerrain(const TerrainGenerator& generator, const WorldConfig& world, vector<int>& IDs, uint32_t* IDIndexes, uint32_t threadCount, uint32_t bandChunks) {
+    if (bandChunks == 0 || bandChunks > (uint32_t)world.horizontalChunks) bandChunks = world.horizontalChunks;
+    int* heightMap = new int[(bandChunks * world.chunkSize + 2) * world.horizontalSize];
+    int* ids = new int[(bandChunks * world.chunkSize + 2) * world.horizontalSize];
+    uint32_t* chunkStarts = new uint32_t[bandChunks * world.horizontalChunks];
+    IDs.clear();
+    uint32_t size = 0;
+    for (int startChunkZ = 0; startChunkZ < world.horizontalChunks; startChunkZ += bandChunks) {
+        int endChunkZ = min(startChunkZ + (int)bandChunks, world.horizontalChunks);
+        generateHeightMap(generator, world, startChunkZ, endChunkZ, heightMap, ids, threadCount);
+
+        // Count IDs in each chunk of the band, then find where each chunk starts
+        countIDs(world, startChunkZ, endChunkZ, heightMap, IDIndexes, chunkStarts, threadCount);
+        for (int chunk = 0; chunk < (endChunkZ - startChunkZ) * world.horizontalChunks; chunk++) {
+            uint32_t chunkSize = chunkStarts[chunk];
+            chunkStarts[chunk] = size;
+            size += chunkSize;
+        }
+
+        // Fill every chunk of the band at its final place
+        IDs.resize(size);
+        generateIDs(world, startChunkZ, endChunkZ, heightMap, ids, IDs.data(), IDIndexes, chunkStarts, threadCount);
+    }
+    IDIndexes[world.columnCount()] = size;
+    delete[] heightMap;
+    delete[] ids;
+    delete[] chunkStarts;
+}
+
+
+void generateTerrain(const TerrainGenerator& generator, const WorldConfig& world, CompactColumns& columns, uint32_t threadCount, uint32_t bandChunks) {
+    if (bandChunks == 0 || bandChunks > (uint32_t)world.horizontalChunks) bandChunks = world.horizontalChunks;
+    int* heightMap = new int[(bandChunks * world.chunkSize + 2) * world.horizontalSize];
+    int* ids = new int[(bandChunks * world.chunkSize + 2) * world.horizontalSize];
+
+    // One block per column, everything below it is invisible
+    columns.world = world;
+    columns.ys.resize(world.columnCount());
+    columns.ids.resize(world.columnCount());
+    columns.bottoms.resize(world.columnCount());
+    columns.index = ColumnIndex(world.horizontalChunks * world.horizontalChunks, world.chunkSize);
+    for (int startChunkZ = 0; startChunkZ < world.horizontalChunks; startChunkZ += bandChunks) {
+        int endChunkZ = min(startChunkZ + (int)bandChunks, world.horizontalChunks);
+        generateHeightMap(generator, world, startChunkZ, endChunkZ, heightMap, ids, threadCount);
+        generateColumns(world, startChunkZ, endChunkZ, heightMap, ids, columns, threadCount);
+    }
+    columns.index.setEnd(world.columnCount());
     delete[] heightMap;
     delete[] ids;
 }
 
 
-void generateHeightMap(int* heightMap, int* ids) {
-    int index = 0;
-    for (int z = 0; z < HORIZONTAL_SIZE; z++) {
-        for (int x = 0; x < HORIZONTAL_SIZE; x++) {
-            int height = 1 + (int)(amplitude * (sin(2 * M_PI * x / blockPeriod) * sin(2 * M_PI * z / blockPeriod) + 1));
-            heightMap[index] = height;
-            ids[index] = height / idHeight + 1;
-            index++;
+void generateTerrain(const TerrainGenerator& generator, const WorldConfig& world, HeightMap& heightMap, uint32_t threadCount) {
+    if (threadCount == 0) threadCount = defaultThreadCount();
+    int* heights = new int[threadCount * world.horizontalSize];
+    int* ids = new int[threadCount * world.horizontalSize];
+    heightMap.world = world;
+    heightMap.heights.resize(world.columnCount());
+    heightMap.ids.resize(world.columnCount());
+    parallelFor(world.horizontalSize, threadCount, [&](uint32_t z, uint32_t thread) {
+        int* rowHeights = heights + thread * world.horizontalSize;
+        int* rowIDs = ids + thread * world.horizontalSize;
+        generator.generate(0, z, world.horizontalSize, rowHeights, rowIDs);
+        for (int x = 0; x < world.horizontalSize; x++) { // Generators don't know the height of the world
+            heightMap.heights[x + z * world.horizontalSize] = min(rowHeights[x], world.verticalSize - 1);
+            heightMap.ids[x + z * world.horizontalSize] = rowIDs[x];
+        }
+    });
+    delete[] heights;
+    delete[] ids;
+}
+
+
+void generateTerrain(const DensityGenerator& generator, const WorldConfig& world, CompactColumns& columns, uint32_t threadCount) {
+    if (threadCount == 0) threadCount = defaultThreadCount();
+    uint32_t chunkCount = world.horizontalChunks * world.horizontalChunks;
+    uint32_t columnWords = (world.chunkSize + 2 * densityMargin) * (world.chunkSize + 2 * densityMargin) * DensityGenerator::wordCount(world.verticalSize);
+    uint64_t* solid = new uint64_t[threadCount * columnWords];
+    uint64_t* visible = new uint64_t[threadCount * columnWords];
+    vector<uint16_t>* chunkYs = new vector<uint16_t>[chunkCount];
+    vector<uint8_t>* chunkIDs = new vector<uint8_t>[chunkCount];
+
+    // Generate each chunk separately, with column starts relative to the chunk
+    columns.world = world;
+    columns.bottoms.assign(world.columnCount(), 0);
+    columns.index = ColumnIndex(chunkCount, world.chunkSize);
+    parallelFor(chunkCount, threadCount, [&](uint32_t chunk, uint32_t thread) {
+        int chunkX = chunk % world.horizontalChunks;
+        int chunkZ = chunk / world.horizontalChunks;
+        generateSolidBlocks(generator, world, chunkX, chunkZ, solid + thread * columnWords);
+        findVisibleBlocks(world, solid + thread * columnWords, visible + thread * columnWords);
+        generateDensityColumns(world, chunkX, chunkZ, solid + thread * columnWords, visible + thread * columnWords, chunkYs[chunk], chunkIDs[chunk], columns);
+    });
+
+    // Put chunks one after the other
+    uint32_t size = 0;
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++) size += chunkYs[chunk].size();
+    columns.ys.resize(size);
+    columns.ids.resize(size);
+    uint32_t start = 0;
+    for (uint32_t chunk = 0; chunk < chunkCount; chunk++) {
+        copy(chunkYs[chunk].begin(), chunkYs[chunk].end(), columns.ys.begin() + start);
+        copy(chunkIDs[chunk].begin(), chunkIDs[chunk].end(), columns.ids.begin() + start);
+        for (uint32_t row = chunk * world.chunkSize; row < (chunk + 1) * world.chunkSize; row++) columns.index.rowStarts[row] += start;
+        start += chunkYs[chunk].size();
+        vector<uint16_t>().swap(chunkYs[chunk]);
+        vector<uint8_t>().swap(chunkIDs[chunk]);
+    }
+    columns.index.setEnd(size);
+    delete[] solid;
+    delete[] visible;
+    delete[] chunkYs;
+    delete[] chunkIDs;
+}
+
+
+void generateHeightMap(const TerrainGenerator& generator, const WorldConfig& world, int startChunkZ, int endChunkZ, int* heightMap, int* ids, uint32_t threadCount) {
+    int startZ = max(startChunkZ * world.chunkSize - 1, 0);
+    int endZ = min(endChunkZ * world.chunkSize + 1, world.horizontalSize);
+    parallelFor(endZ - startZ, threadCount, [&](uint32_t row, uint32_t) {
+        int z = startZ + row;
+        int index = (z - startChunkZ * world.chunkSize + 1) * world.horizontalSize;
+        generator.generate(0, z, world.horizontalSize, heightMap + index, ids + index);
+        for (int x = 0; x < world.horizontalSize; x++) { // Generators don't know the height of the world
+            if (heightMap[index + x] > world.verticalSize - 1) heightMap[index + x] = world.verticalSize - 1;
+        }
+    });
+}
+
+
+// Store the start index of each (x, z) relative to its chunk in IDIndexes and the size of each chunk of the band in chunkSizes
+void countIDs(const WorldConfig& world, int startChunkZ, int endChunkZ, int* heightMap, uint32_t* IDIndexes, uint32_t* chunkSizes, uint32_t threadCount) {
+    parallelFor((endChunkZ - startChunkZ) * world.horizontalChunks, threadCount, [&](uint32_t bandChunk, uint32_t) {
+        int chunkX = bandChunk % world.horizontalChunks;
+        int chunkZ = startChunkZ + bandChunk / world.horizontalChunks;
+        uint32_t size = 0;
+        for (int zInChunk = 0; zInChunk < world.chunkSize; zInChunk++) {
+            for (int xInChunk = 0; xInChunk < world.chunkSize; xInChunk++) {
+                int x = chunkX * world.chunkSize + xInChunk;
+                int z = chunkZ * world.chunkSize + zInChunk;
+                int y = heightMap[x + (z - startChunkZ * world.chunkSize + 1) * world.horizontalSize];
+                IDIndexes[(chunkX + chunkZ * world.horizontalChunks) * world.chunkSize * world.chunkSize + xInChunk + zInChunk * world.chunkSize] = size;
+                size += 2 * (y - minSurroundingY(world, startChunkZ * world.chunkSize, heightMap, x, z) + 1);
+            }
+        }
+        chunkSizes[bandChunk] = size;
+    });
+}
+
+
+void generateIDs(const WorldConfig& world, int startChunkZ, int endChunkZ, int* heightMap, int* ids, int* IDs, uint32_t* IDIndexes, uint32_t* chunkStarts, uint32_t threadCount) {
+    parallelFor((endChunkZ - startChunkZ) * world.horizontalChunks, threadCount, [&](uint32_t bandChunk, uint32_t) {
+        int chunkX = bandChunk % world.horizontalChunks;
+        int chunkZ = startChunkZ + bandChunk / world.horizontalChunks;
+        for (int zInChunk = 0; zInChunk < world.chunkSize; zInChunk++) {
+            for (int xInChunk = 0; xInChunk < world.chunkSize; xInChunk++) {
+                int x = chunkX * world.chunkSize + xInChunk;
+                int z = chunkZ * world.chunkSize + zInChunk;
+                int bandIndex = x + (z - startChunkZ * world.chunkSize + 1) * world.horizontalSize;
+                int y = heightMap[bandIndex];
+                uint32_t xzIndex = (chunkX + chunkZ * world.horizontalChunks) * world.chunkSize * world.chunkSize + xInChunk + zInChunk * world.chunkSize;
+                IDIndexes[xzIndex] += chunkStarts[bandChunk];
+                int* column = IDs + IDIndexes[xzIndex];
+
+                // Add zeros below the block to not render invisible faces, then add the block
+                for (int belowY = minSurroundingY(world, startChunkZ * world.chunkSize, heightMap, x, z); belowY < y; belowY++) {
+                    *column++ = belowY;
+                    *column++ = 0;
+                }
+                *column++ = y;
+                *column++ = ids[bandIndex];
+            }
+        }
+    });
+}
+
+
+void generateColumns(const WorldConfig& world, int startChunkZ, int endChunkZ, int* heightMap, int* ids, CompactColumns& columns, uint32_t threadCount) {
+    parallelFor((endChunkZ - startChunkZ) * world.horizontalChunks, threadCount, [&](uint32_t bandChunk, uint32_t) {
+        int chunkX = bandChunk % world.horizontalChunks;
+        int chunkZ = startChunkZ + bandChunk / world.horizontalChunks;
+        for (int zInChunk = 0; zInChunk < world.chunkSize; zInChunk++) {
+            for (int xInChunk = 0; xInChunk < world.chunkSize; xInChunk++) {
+                int x = chunkX * world.chunkSize + xInChunk;
+                int z = chunkZ * world.chunkSize + zInChunk;
+                int bandIndex = x + (z - startChunkZ * world.chunkSize + 1) * world.horizontalSize;
+                uint32_t xzIndex = (chunkX + chunkZ * world.horizontalChunks) * world.chunkSize * world.chunkSize + xInChunk + zInChunk * world.chunkSize;
+                columns.ys[xzIndex] = heightMap[bandIndex];
+                columns.ids[xzIndex] = ids[bandIndex];
+                columns.bottoms[xzIndex] = minSurroundingY(world, startChunkZ * world.chunkSize, heightMap, x, z);
+                columns.index.setStart(xzIndex, xzIndex);
+            }
+        }
+    });
+}
+
+
+// Lowest height between the block below (x, z) and the blocks around (x, z) (startZ: first row of the band without margin)
+int minSurroundingY(const WorldConfig& world, int startZ, int* heightMap, int x, int z) {
+    int index = x + (z - startZ + 1) * world.horizontalSize;
+    int minY = heightMap[index] - 1;
+    if (x > 0) minY = min(minY, heightMap[index - 1]);
+    if (x < world.horizontalSize - 1) minY = min(minY, heightMap[index + 1]);
+    if (z > 0) minY = min(minY, heightMap[index - world.horizontalSize]);
+    if (z < world.horizontalSize - 1) minY = min(minY, heightMap[index + world.horizontalSize]);
+    return minY;
+}
+
+
+// Solid blocks of a chunk and its margin (columns outside the world are solid, like for the mesher)
+void generateSolidBlocks(const DensityGenerator& generator, const WorldConfig& world, int chunkX, int chunkZ, uint64_t* solid) {
+    int words = DensityGenerator::wordCount(world.verticalSize);
+    int size = world.chunkSize + 2 * densityMargin;
+    int startX = chunkX * world.chunkSize - densityMargin;
+    uint64_t* fullColumn = new uint64_t[words];
+    fill(fullColumn, fullColumn + words, ~(uint64_t)0);
+    if (world.verticalSize % 64 != 0) fullColumn[words - 1] = ((uint64_t)1 << (world.verticalSize % 64)) - 1;
+    for (int z = 0; z < size; z++) {
+        int worldZ = chunkZ * world.chunkSize - densityMargin + z;
+        uint64_t* row = solid + z * size * words;
+        if (worldZ >= 0 && worldZ < world.horizontalSize) generator.generate(startX, worldZ, size, world.verticalSize, row);
+        for (int x = 0; x < size; x++) {
+            if (worldZ < 0 || worldZ >= world.horizontalSize || startX + x < 0 || startX + x >= world.horizontalSize)
+                copy(fullColumn, fullColumn + words, row + x * words);
         }
     }
+    delete[] fullColumn;
 }
 
 
-void generateIDs(int* heightMap, int* ids, vector<int>& IDs, uint32_t* IDIndexes) {
-    for (int chunkZ = 0; chunkZ < HORIZONTAL_CHUNKS; chunkZ++) {
-        for (int chunkX = 0; chunkX < HORIZONTAL_CHUNKS; chunkX++) {
-            for (int zInChunk = 0; zInChunk < CHUNK_SIZE; zInChunk++) {
-                for (int xInChunk = 0; xInChunk < CHUNK_SIZE; xInChunk++) {
-                    int x = chunkX * CHUNK_SIZE + xInChunk;
-                    int z = chunkZ * CHUNK_SIZE + zInChunk;
-                    int y = heightMap[x + z * HORIZONTAL_SIZE];
-                    IDIndexes[(chunkX + chunkZ * HORIZONTAL_CHUNKS) * CHUNK_SIZE * CHUNK_SIZE + xInChunk + zInChunk * CHUNK_SIZE] = IDs.size();
-
-                    // Add zeros below the block to not render invisible faces, then add the block
-                    int minSurroundingY = y - 1;
-                    if (x > 0) minSurroundingY = min(minSurroundingY, heightMap[x - 1 + z * HORIZONTAL_SIZE]);
-                    if (x < HORIZONTAL_SIZE - 1) minSurroundingY = min(minSurroundingY, heightMap[x + 1 + z * HORIZONTAL_SIZE]);
-                    if (z > 0) minSurroundingY = min(minSurroundingY, heightMap[x + (z - 1) * HORIZONTAL_SIZE]);
-                    if (z < HORIZONTAL_SIZE - 1) minSurroundingY = min(minSurroundingY, heightMap[x + (z + 1) * HORIZONTAL_SIZE]);
-                    for (int belowY = minSurroundingY; belowY < y; belowY++) {
-                        IDs.push_back(belowY);
-                        IDs.push_back(0);
+// Solid blocks next to air, for the chunk and 1 column around it (below the world is solid, above is air)
+void findVisibleBlocks(const WorldConfig& world, uint64_t* solid, uint64_t* visible) {
+    int words = DensityGenerator::wordCount(world.verticalSize);
+    int size = world.chunkSize + 2 * densityMargin;
+    for (int z = 1; z < size - 1; z++) {
+        for (int x = 1; x < size - 1; x++) {
+            const uint64_t* column = solid + (x + z * size) * words;
+            for (int i = 0; i < words; i++) {
+                uint64_t below = (column[i] << 1) | (i == 0 ? 1 : column[i - 1] >> 63);
+                uint64_t above = (column[i] >> 1) | (i == words - 1 ? 0 : column[i + 1] << 63);
+                uint64_t covered = below & above & column[i - words] & column[i + words] & column[i - size * words] & column[i + size * words];
+                visible[(x + z * size) * words + i] = column[i] & ~covered;
+            }
+        }
+    }
+}
+
+
+// Add the visible blocks of a chunk and the invisible blocks next to them to columns (column starts relative to the chunk)
+void generateDensityColumns(const WorldConfig& world, int chunkX, int chunkZ, uint64_t* solid, uint64_t* visible, vector<uint16_t>& ys, vector<uint8_t>& ids, CompactColumns& columns) {
+    int words = DensityGenerator::wordCount(world.verticalSize);
+    int size = world.chunkSize + 2 * densityMargin;
+    uint32_t xzIndex = (chunkX + chunkZ * world.horizontalChunks) * world.chunkSize * world.chunkSize;
+    for (int z = densityMargin; z < size - densityMargin; z++) {
+        for (int x = densityMargin; x < size - densityMargin; x++) {
+            const uint64_t* column = solid + (x + z * size) * words;
+            const uint64_t* visibleColumn = visible + (x + z * size) * words;
+            uint32_t start = ys.size();
+            columns.index.setStart(xzIndex, start);
+            bool first = true;
+            for (int i = 0; i < words; i++) {
+                uint64_t below = (visibleColumn[i] << 1) | (i == 0 ? 0 : visibleColumn[i - 1] >> 63);
+                uint64_t above = (visibleColumn[i] >> 1) | (i == words - 1 ? 0 : visibleColumn[i + 1] << 63);
+                uint64_t nextToVisible = below | above | visibleColumn[i - words] | visibleColumn[i + words] | visibleColumn[i - size * words] | visibleColumn[i + size * words];
+                uint64_t blocks = visibleColumn[i] | (column[i] & nextToVisible);
+                uint64_t solidAbove = (column[i] >> 1) | (i == words - 1 ? 0 : column[i + 1] << 63);
+                for (; blocks != 0; blocks &= blocks - 1) {
+                    int bit = __builtin_ctzll(blocks);
+                    int y = i * 64 + bit;
+                    bool isVisible = (visibleColumn[i] >> bit) & 1;
+
+                    // Invisible blocks directly below the first stored block are not stored (see CompactColumns.hpp)
+                    if (first) {
+                        columns.bottoms[xzIndex] = y;
+                        first = false;
                     }
-                    IDs.push_back(y);
-                    IDs.push_back(ids[x + z * HORIZONTAL_SIZE]);
+                    if (ys.size() == start && !isVisible && ((blocks >> bit) & 2) != 0) continue;
+                    ys.push_back(y);
+                    ids.push_back(isVisible ? DensityGenerator::blockID(y, (solidAbove >> bit) & 1) : 0);
                 }
             }
+            xzIndex++;
         }
     }
-    IDIndexes[HORIZONTAL_SIZE * HORIZONTAL_SIZE] = IDs.size();
-}
\ No newline at end of file
+}
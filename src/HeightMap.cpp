@@ -0,0 +1,21 @@
+#include "HeightMap.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "WorldConfig.hpp"
+
+using namespace std;
+
+
+HeightMap::HeightMap(const WorldConfig& world) :
+    world(world),
+    heights(world.columnCount(), 1),
+    ids(world.columnCount(), 0) {
+}
+
+
+size_t HeightMap::memorySize() const {
+    return heights.size() * sizeof(uint16_t) + ids.size() * sizeof(uint8_t);
+}
@@ -0,0 +1,73 @@
+#include "MappedFile.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+uint64_t alignUp(uint64_t offset);
+
+
+MappedFile::MappedFile(char const* path, size_t minSize) :
+    data(MAP_FAILED),
+    size(0) {
+    int file = open(path, O_RDONLY);
+    if (file == -1) throw runtime_error(string("Can't open file ") + path);
+    struct stat status;
+    if (fstat(file, &status) == -1 || (size_t)status.st_size < minSize || status.st_size == 0) {
+        close(file);
+        throw runtime_error(string("Invalid file ") + path);
+    }
+    size = status.st_size;
+    data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (data == MAP_FAILED) throw runtime_error(string("Can't map file ") + path);
+}
+
+
+MappedFile::~MappedFile() {
+    munmap(data, size);
+}
+
+
+void MappedFile::placeSections(size_t headerSize, int sectionCount, const uint64_t* sectionSizes, uint64_t* sectionOffsets) {
+    uint64_t offset = alignUp(headerSize);
+    for (int i = 0; i < sectionCount; i++) {
+        sectionOffsets[i] = offset;
+        offset = alignUp(offset + sectionSizes[i]);
+    }
+}
+
+
+void MappedFile::write(char const* path, const void* header, size_t headerSize, int sectionCount, const void* const* sections, const uint64_t* sectionSizes, const uint64_t* sectionOffsets) {
+    // Write everything to a temporary file, then replace the old file
+    string temporaryPath = string(path) + ".tmp";
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) throw runtime_error("Can't create file " + temporaryPath);
+    static const char padding[alignment] = {};
+    bool ok = fwrite(header, headerSize, 1, file) == 1;
+    uint64_t position = headerSize;
+    for (int i = 0; i < sectionCount && ok; i++) {
+        ok = fwrite(padding, 1, sectionOffsets[i] - position, file) == sectionOffsets[i] - position
+            && fwrite(sections[i], 1, sectionSizes[i], file) == sectionSizes[i];
+        position = sectionOffsets[i] + sectionSizes[i];
+    }
+    ok = fclose(file) == 0 && ok;
+    if (!ok || rename(temporaryPath.c_str(), path) != 0) {
+        remove(temporaryPath.c_str());
+        throw runtime_error(string("Can't write file ") + path);
+    }
+}
+
+
+// Next multiple of alignment
+uint64_t alignUp(uint64_t offset) {
+    return (offset + MappedFile::alignment - 1) / MappedFile::alignment * MappedFile::alignment;
+}
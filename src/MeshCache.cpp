@@ -0,0 +1,78 @@
+#include "MeshCache.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#include "VoxelMesh.hpp"
+#include "MappedFile.hpp"
+#include "GenerateMesh.hpp"
+
+using namespace std;
+
+static constexpr char magic[8] = "VXMESH";
+static constexpr int sectionCount = 2; // MeshData, Square
+
+bool validMeshes(const MeshData* meshes, uint32_t meshCount, uint32_t squareCount);
+
+struct MeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t mesherVersion;
+    uint64_t worldHash;
+    uint32_t levelsOfDetail;
+    uint64_t sectionOffsets[sectionCount];
+    uint64_t sectionCounts[sectionCount];
+};
+
+
+MeshCache::MeshCache(char const* path) :
+    file(path, sizeof(MeshCacheHeader)) {
+    // Check the header and the sections
+    const MeshCacheHeader& header = *(const MeshCacheHeader*)file.bytes();
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0) throw runtime_error(string("Not a mesh cache file: ") + path);
+    if (header.version != version) throw runtime_error(string("Unsupported mesh cache file version: ") + path);
+    if (header.mesherVersion != mesherVersion) throw runtime_error(string("Mesh cache file from another mesher version: ") + path);
+    if (header.sectionCounts[0] > UINT32_MAX || header.sectionCounts[1] > UINT32_MAX
+        || !file.validSection(header.sectionOffsets[0], header.sectionCounts[0] * sizeof(MeshData))
+        || !file.validSection(header.sectionOffsets[1], header.sectionCounts[1] * sizeof(Square)))
+        throw runtime_error(string("Invalid mesh cache file sections: ") + path);
+
+    hash = header.worldHash;
+    lodMeshes = header.levelsOfDetail != 0;
+    meshes = (const MeshData*)(file.bytes() + header.sectionOffsets[0]);
+    meshesCount = header.sectionCounts[0];
+    squaresData = (const Square*)(file.bytes() + header.sectionOffsets[1]);
+    squaresCount = header.sectionCounts[1];
+    if (!validMeshes(meshes, meshesCount, squaresCount)) throw runtime_error(string("Invalid mesh cache file meshes: ") + path);
+}
+
+
+void MeshCache::save(char const* path, uint64_t worldHash, bool levelsOfDetail, const MeshData* meshData, uint32_t meshCount, const Square* squares, uint32_t squareCount) {
+    const void* sections[sectionCount] = { meshData, squares };
+    MeshCacheHeader header = {};
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.mesherVersion = mesherVersion;
+    header.worldHash = worldHash;
+    header.levelsOfDetail = levelsOfDetail;
+    header.sectionCounts[0] = meshCount;
+    header.sectionCounts[1] = squareCount;
+    uint64_t sectionSizes[sectionCount] = { meshCount * sizeof(MeshData), squareCount * sizeof(Square) };
+    MappedFile::placeSections(sizeof(header), sectionCount, sectionSizes, header.sectionOffsets);
+    MappedFile::write(path, &header, sizeof(header), sectionCount, sections, sectionSizes, header.sectionOffsets);
+}
+
+
+// Check that the squares of each mesh are in the square section and that its normal exists (the renderer uploads and draws them as they are)
+bool validMeshes(const MeshData* meshes, uint32_t meshCount, uint32_t squareCount) {
+    for (uint32_t i = 0; i < meshCount; i++) {
+        uint32_t normal = meshes[i].data1 & 7;
+        uint64_t meshSquares = meshes[i].data1 >> 5;
+        uint64_t startSquare = meshes[i].data2;
+        if (normal > (uint32_t)CubeNormal::zNegative || startSquare + meshSquares > squareCount) return false;
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#include "MeshSink.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#include "VoxelMesh.hpp"
+
+using namespace std;
+
+
+ArrayMeshSink::ArrayMeshSink(MeshData* meshData, uint32_t meshCapacity, Square* squares, uint32_t squareCapacity, uint32_t startSquare) :
+    meshData(meshData),
+    meshCapacity(meshCapacity),
+    squares(squares),
+    squareCapacity(squareCapacity),
+    startSquare(startSquare),
+    meshes(0),
+    squareTotal(0) {
+}
+
+
+void ArrayMeshSink::addMeshes(uint32_t, uint32_t, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) {
+    bool fits = complete() && this->meshes + meshCount <= meshCapacity && squareTotal + squareCount <= squareCapacity;
+    if (fits) {
+        uint32_t start = startSquare + squareTotal;
+        for (uint32_t i = 0; i < meshCount; i++) {
+            meshData[this->meshes + i] = MeshData(meshes[i], start);
+            start += meshes[i].squaresCount;
+        }
+        copy(squares, squares + squareCount, this->squares + squareTotal);
+    }
+    else { // Count everything from now on so that complete() stays false
+        meshCapacity = 0;
+        squareCapacity = 0;
+    }
+    this->meshes += meshCount;
+    squareTotal += squareCount;
+}
+
+
+VectorMeshSink::VectorMeshSink(vector<MeshData>& meshData, vector<Square>& squares) :
+    meshData(meshData),
+    squares(squares) {
+}
+
+
+void VectorMeshSink::addMeshes(uint32_t, uint32_t, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) {
+    addMeshes(meshes, meshCount, squares, squareCount);
+}
+
+
+void VectorMeshSink::addMeshes(const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) {
+    uint32_t start = this->squares.size();
+    for (uint32_t i = 0; i < meshCount; i++) {
+        meshData.push_back(MeshData(meshes[i], start));
+        start += meshes[i].squaresCount;
+    }
+    this->squares.insert(this->squares.end(), squares, squares + squareCount);
+}
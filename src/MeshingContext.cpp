@@ -0,0 +1,98 @@
+#include "MeshingContext.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include <sys/mman.h>
+
+#include "VoxelMesh.hpp"
+
+using namespace std;
+
+void* mapHugePages(size_t size, bool hugePages);
+
+
+MeshingContext::MeshingContext(bool hugePages, bool levelsOfDetail) :
+    hugePages(hugePages),
+    lodMeshes(levelsOfDetail) {
+    for (int i = 0; i < (int)MeshingBuffer::count; i++) {
+        buffers[i] = nullptr;
+        sizes[i] = 0;
+    }
+}
+
+
+MeshingContext::~MeshingContext() {
+    for (int i = 0; i < (int)MeshingBuffer::count; i++) freeBuffer(i);
+}
+
+
+void* MeshingContext::bytes(MeshingBuffer buffer, size_t size) {
+    int i = (int)buffer;
+    if (size <= sizes[i]) return buffers[i];
+    freeBuffer(i);
+    if (size >= hugePageSize) {
+        size = (size + hugePageSize - 1) / hugePageSize * hugePageSize;
+        buffers[i] = mapHugePages(size, hugePages);
+    }
+    else buffers[i] = new uint8_t[size] { 0 };
+    sizes[i] = size;
+    return buffers[i];
+}
+
+
+vector<VoxelMesh>* MeshingContext::threadMeshes(uint32_t threadCount) {
+    if (meshes.size() < threadCount) meshes.resize(threadCount);
+    for (uint32_t thread = 0; thread < threadCount; thread++) meshes[thread].clear();
+    return meshes.data();
+}
+
+
+vector<Square>* MeshingContext::threadSquares(uint32_t threadCount) {
+    if (squares.size() < threadCount) squares.resize(threadCount);
+    for (uint32_t thread = 0; thread < threadCount; thread++) squares[thread].clear();
+    return squares.data();
+}
+
+
+void MeshingContext::release() {
+    for (int i = 0; i < (int)MeshingBuffer::count; i++) freeBuffer(i);
+    vector<vector<VoxelMesh>>().swap(meshes);
+    vector<vector<Square>>().swap(squares);
+}
+
+
+size_t MeshingContext::memorySize() const {
+    size_t size = 0;
+    for (int i = 0; i < (int)MeshingBuffer::count; i++) size += sizes[i];
+    for (const vector<VoxelMesh>& threadMeshes : meshes) size += threadMeshes.capacity() * sizeof(VoxelMesh);
+    for (const vector<Square>& threadSquares : squares) size += threadSquares.capacity() * sizeof(Square);
+    return size;
+}
+
+
+void MeshingContext::freeBuffer(int buffer) {
+    if (sizes[buffer] >= hugePageSize) munmap(buffers[buffer], sizes[buffer]);
+    else delete[] (uint8_t*)buffers[buffer];
+    buffers[buffer] = nullptr;
+    sizes[buffer] = 0;
+}
+
+
+// Map zeroed memory aligned to huge pages (size must be a multiple of hugePageSize)
+void* mapHugePages(size_t size, bool hugePages) {
+    size_t hugePageSize = MeshingContext::hugePageSize;
+    uint8_t* mapping = (uint8_t*)mmap(nullptr, size + hugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) throw runtime_error("Can't allocate meshing buffer");
+
+    // Only keep the aligned part
+    uint8_t* start = (uint8_t*)(((uintptr_t)mapping + hugePageSize - 1) / hugePageSize * hugePageSize);
+    if (start != mapping) munmap(mapping, start - mapping);
+    munmap(start + size, mapping + hugePageSize - start);
+
+#ifdef MADV_HUGEPAGE
+    if (hugePages) madvise(start, size, MADV_HUGEPAGE); // Only a hint, fails if transparent huge pages are disabled
+#endif
+    return start;
+}
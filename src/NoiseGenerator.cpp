@@ -0,0 +1,86 @@
+#include "NoiseGenerator.hpp"
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "SimdNoise.hpp"
+
+using namespace std;
+
+
+static constexpr int minHeight = 4;
+static constexpr int heightRange = 420; // Maximum height above minHeight (higher than smaller worlds, generateTerrain() clamps it)
+static constexpr float persistence = 0.5f; // Amplitude ratio between two octaves
+static constexpr uint32_t octaveSeedStep = 0x9e3779b9;
+static constexpr int sandHeight = 30; // Highest sand block
+static constexpr int grassHeight = 120; // Highest grass block
+static constexpr int stoneHeight = 230; // Highest stone block
+
+
+
+NoiseGenerator::NoiseGenerator(uint32_t seed, int octaves, float period) :
+    seed(seed),
+    octaves(octaves),
+    frequency(1 / period) {
+}
+
+
+void NoiseGenerator::generate(int startX, int z, int count, int* heights, int* ids) const {
+    int x = startX;
+    for (; x + lanes <= startX + count; x += lanes) {
+        generateLanes(x, z, heights + x - startX, ids + x - startX);
+    }
+    if (x < startX + count) { // Last columns (don't fill a whole SIMD register)
+        int lastHeights[lanes];
+        int lastIDs[lanes];
+        generateLanes(x, z, lastHeights, lastIDs);
+        copy(lastHeights, lastHeights + startX + count - x, heights + x - startX);
+        copy(lastIDs, lastIDs + startX + count - x, ids + x - startX);
+    }
+}
+
+
+void NoiseGenerator::generateLanes(int startX, int z, int* heights, int* ids) const {
+    Floats x = toFloats(add(ints(startX), laneIndices()));
+    Floats noise = floats(0);
+    float amplitude = 1;
+    float totalAmplitude = 0;
+    float octaveFrequency = frequency;
+    Ints octaveSeed = ints(seed);
+    for (int octave = 0; octave < octaves; octave++) {
+        // Lattice cell and position in the cell (z is the same for all lanes)
+        Floats positionX = mul(x, floats(octaveFrequency));
+        Floats cellX = roundDown(positionX);
+        float cellZ = floor(z * octaveFrequency);
+        Floats weightX = fade(sub(positionX, cellX));
+        Floats weightZ = fade(floats(z * octaveFrequency - cellZ));
+        Ints latticeX = toInts(cellX);
+        Ints latticeZ = ints((int32_t)cellZ);
+
+        // Interpolate the 4 corners of the cell
+        Floats before = interpolate(latticeHash(latticeX, latticeZ, octaveSeed), latticeHash(add(latticeX, ints(1)), latticeZ, octaveSeed), weightX);
+        Ints nextZ = add(latticeZ, ints(1));
+        Floats after = interpolate(latticeHash(latticeX, nextZ, octaveSeed), latticeHash(add(latticeX, ints(1)), nextZ, octaveSeed), weightX);
+        noise = add(noise, mul(interpolate(before, after, weightZ), floats(amplitude)));
+
+        totalAmplitude += amplitude;
+        amplitude *= persistence;
+        octaveFrequency *= 2;
+        octaveSeed = add(octaveSeed, ints(octaveSeedStep));
+    }
+
+    // Flatten valleys and sharpen mountains
+    noise = mul(noise, floats(1 / totalAmplitude));
+    noise = mul(noise, noise);
+    store(heights, add(ints(minHeight), toInts(mul(noise, floats(heightRange)))));
+    for (int i = 0; i < lanes; i++) ids[i] = blockID(heights[i]);
+}
+
+
+int NoiseGenerator::blockID(int height) {
+    if (height <= sandHeight) return 1;
+    if (height <= grassHeight) return 2;
+    if (height <= stoneHeight) return 3;
+    return 4;
+}
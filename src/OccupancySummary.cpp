@@ -0,0 +1,174 @@
+#include "OccupancySummary.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+#include "Parallel.hpp"
+#include "CompactColumns.hpp"
+#include "PalettedChunks.hpp"
+#include "WorldConfig.hpp"
+
+using namespace std;
+
+
+OccupancySummary::OccupancySummary(const CompactColumnsView& columns, uint32_t threadCount) :
+    world(columns.world),
+    occupied(world.horizontalChunks * world.horizontalChunks * world.verticalChunks),
+    full(world.horizontalChunks * world.horizontalChunks * world.verticalChunks) {
+    parallelFor(world.horizontalChunks * world.horizontalChunks, threadCount, [&](uint32_t chunk, uint32_t) {
+        update(chunk % world.horizontalChunks, chunk / world.horizontalChunks, columns);
+    });
+}
+
+
+OccupancySummary::OccupancySummary(const PalettedChunks& chunks, uint32_t threadCount) :
+    world(chunks.world),
+    occupied(world.horizontalChunks * world.horizontalChunks * world.verticalChunks),
+    full(world.horizontalChunks * world.horizontalChunks * world.verticalChunks) {
+    parallelFor(world.horizontalChunks * world.horizontalChunks * world.verticalChunks, threadCount, [&](uint32_t chunk, uint32_t) {
+        uint32_t chunkY = chunk % world.verticalChunks;
+        uint32_t xzChunk = chunk / world.verticalChunks;
+        update(xzChunk % world.horizontalChunks, chunkY, xzChunk / world.horizontalChunks, chunks);
+    });
+}
+
+
+// Each column gives the sub-blocks (on y) it has solid blocks in and the sub-blocks it is full in,
+// sub-blocks of the chunk column are the union and the intersection of the columns they contain
+void OccupancySummary::update(uint32_t chunkX, uint32_t chunkZ, const CompactColumnsView& columns) {
+    int chunkSize = world.chunkSize;
+    int size = chunkSize / subBlocks; // Size of a sub-block
+    int ySubBlocks = world.verticalSize / size; // At most 64
+    uint64_t fieldMask = ((uint64_t)1 << size) - 1;
+    uint64_t solid[8]; // Solid blocks of a column (at most 512)
+    uint64_t subOccupied[subBlocks * subBlocks]; // Bit y of (x, z) : sub-block (x, y, z) of the chunk column
+    uint64_t subFull[subBlocks * subBlocks];
+    fill(subOccupied, subOccupied + subBlocks * subBlocks, 0);
+    fill(subFull, subFull + subBlocks * subBlocks, ~(uint64_t)0);
+
+    uint32_t xzIndex = (chunkX + chunkZ * world.horizontalChunks) * chunkSize * chunkSize;
+    for (int z = 0; z < chunkSize; z++) {
+        for (int x = 0; x < chunkSize; x++) {
+            uint64_t& columnOccupied = subOccupied[x / size + z / size * subBlocks];
+            uint64_t& columnFull = subFull[x / size + z / size * subBlocks];
+            uint32_t start = columns.index.start(xzIndex);
+            uint32_t end = columns.index.end(xzIndex);
+            if (start == end) {
+                columnFull = 0;
+                xzIndex++;
+                continue;
+            }
+
+            // Solid blocks of the column, then the sub-blocks between the lowest and the highest block
+            int bottom = min((int)columns.bottoms[xzIndex], (int)columns.ys[start]);
+            int top = columns.ys[end - 1];
+            fill(solid + bottom / 64, solid + top / 64 + 1, 0);
+            for (int y = bottom; y < columns.ys[start]; y++) solid[y / 64] |= (uint64_t)1 << (y % 64); // Invisible blocks
+            for (uint32_t i = start; i < end; i++) solid[columns.ys[i] / 64] |= (uint64_t)1 << (columns.ys[i] % 64);
+            uint64_t occupiedY = 0;
+            uint64_t fullY = 0;
+            for (int y = bottom / size; y <= top / size; y++) {
+                uint64_t field = (solid[y * size / 64] >> (y * size % 64)) & fieldMask;
+                if (field != 0) occupiedY |= (uint64_t)1 << y;
+                if (field == fieldMask) fullY |= (uint64_t)1 << y;
+            }
+            columnOccupied |= occupiedY;
+            columnFull &= fullY;
+            xzIndex++;
+        }
+    }
+
+    // Split the sub-blocks of the chunk column in chunks
+    for (int chunkY = 0; chunkY < world.verticalChunks; chunkY++) {
+        uint32_t chunk = chunkY + (chunkX + chunkZ * world.horizontalChunks) * world.verticalChunks;
+        occupied[chunk] = 0;
+        full[chunk] = 0;
+        for (int z = 0; z < subBlocks; z++) {
+            for (int y = 0; y < subBlocks && chunkY * subBlocks + y < ySubBlocks; y++) {
+                for (int x = 0; x < subBlocks; x++) {
+                    int bit = x + y * subBlocks + z * subBlocks * subBlocks;
+                    occupied[chunk] |= ((subOccupied[x + z * subBlocks] >> (chunkY * subBlocks + y)) & 1) << bit;
+                    full[chunk] |= ((subFull[x + z * subBlocks] >> (chunkY * subBlocks + y)) & 1) << bit;
+                }
+            }
+        }
+    }
+}
+
+
+void OccupancySummary::update(uint32_t chunkX, uint32_t chunkY, uint32_t chunkZ, const PalettedChunks& chunks) {
+    uint32_t chunk = chunkY + (chunkX + chunkZ * world.horizontalChunks) * world.verticalChunks;
+    const PalettedChunk& blocks = chunks.chunk(chunkX, chunkY, chunkZ);
+    occupied[chunk] = 0;
+    full[chunk] = 0;
+    if (blocks.empty()) return;
+
+    int size = world.chunkSize / subBlocks;
+    uint64_t fieldMask = ((uint64_t)1 << size) - 1;
+    uint64_t notFull = 0;
+    for (int z = 0; z < world.chunkSize; z++) {
+        for (int y = 0; y < world.chunkSize; y++) {
+            uint64_t row = blocks.solidRow(y, z);
+            for (int x = 0; x < subBlocks; x++) {
+                uint64_t field = (row >> (x * size)) & fieldMask;
+                int bit = x + y / size * subBlocks + z / size * subBlocks * subBlocks;
+                if (field != 0) occupied[chunk] |= (uint64_t)1 << bit;
+                if (field != fieldMask) notFull |= (uint64_t)1 << bit;
+            }
+        }
+    }
+    full[chunk] = ~notFull;
+}
+
+
+bool OccupancySummary::maybeSolid(int x, int y, int z) const {
+    if (y < 0 || y >= world.verticalSize) return false;
+    if (x < 0 || z < 0 || x >= world.horizontalSize || z >= world.horizontalSize) return true;
+    int size = world.chunkSize / subBlocks;
+    uint32_t chunk = y / world.chunkSize + (x / world.chunkSize + z / world.chunkSize * world.horizontalChunks) * world.verticalChunks;
+    int bit = x % world.chunkSize / size + y % world.chunkSize / size * subBlocks + z % world.chunkSize / size * subBlocks * subBlocks;
+    return (occupied[chunk] >> bit) & 1;
+}
+
+
+bool OccupancySummary::canHaveFaces(uint32_t chunkX, uint32_t chunkZ, int startY, int endY) const {
+    int size = world.chunkSize / subBlocks;
+    startY = max(startY, 0);
+    endY = min(endY, world.verticalSize);
+    for (int y = startY / size; y * size < endY; y++) {
+        uint32_t chunk = y / subBlocks + (chunkX + chunkZ * world.horizontalChunks) * world.verticalChunks;
+        for (int z = 0; z < subBlocks; z++) {
+            for (int x = 0; x < subBlocks; x++) {
+                int bit = x + y % subBlocks * subBlocks + z * subBlocks * subBlocks;
+                if (((occupied[chunk] >> bit) & 1) == 0) continue; // Empty
+                if (((full[chunk] >> bit) & 1) == 0) return true; // Solid blocks next to air
+
+                // Full, faces only on its sides
+                int worldX = chunkX * subBlocks + x;
+                int worldZ = chunkZ * subBlocks + z;
+                if (!fullSubBlock(worldX - 1, y, worldZ) || !fullSubBlock(worldX + 1, y, worldZ)) return true;
+                if (!fullSubBlock(worldX, y - 1, worldZ) || !fullSubBlock(worldX, y + 1, worldZ)) return true;
+                if (!fullSubBlock(worldX, y, worldZ - 1) || !fullSubBlock(worldX, y, worldZ + 1)) return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+size_t OccupancySummary::memorySize() const {
+    return (occupied.size() + full.size()) * sizeof(uint64_t);
+}
+
+
+// Whether a sub-block (coordinates in sub-blocks in the world) is full
+bool OccupancySummary::fullSubBlock(int x, int y, int z) const {
+    int horizontalSubBlocks = world.horizontalChunks * subBlocks;
+    if (x < 0 || z < 0 || x >= horizontalSubBlocks || z >= horizontalSubBlocks) return true;
+    if (y < 0 || y >= world.verticalChunks * subBlocks) return false;
+    uint32_t chunk = y / subBlocks + (x / subBlocks + z / subBlocks * world.horizontalChunks) * world.verticalChunks;
+    int bit = x % subBlocks + y % subBlocks * subBlocks + z % subBlocks * subBlocks * subBlocks;
+    return (full[chunk] >> bit) & 1;
+}
@@ -0,0 +1,183 @@
+#include "PalettedChunks.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include "CompactColumns.hpp"
+#include "WorldConfig.hpp"
+#include "Parallel.hpp"
+
+using namespace std;
+
+template<typename AddBlocks> void convertColumns(const WorldConfig& world, vector<PalettedChunk>& chunks, uint32_t threadCount, AddBlocks addBlocks);
+uint64_t nonZeroFields(uint64_t word, uint32_t bits);
+
+
+PalettedChunk::PalettedChunk(uint32_t size) :
+    palette { air },
+    size(size),
+    bits(0) {
+}
+
+
+PalettedChunk::PalettedChunk(uint32_t size, const int16_t* blocks) :
+    palette { air },
+    size(size),
+    bits(0) {
+    // Find the palette
+    int16_t idToIndex[256];
+    fill(idToIndex, idToIndex + 256, 0);
+    for (uint32_t i = 0; i < size * size * size; i++) {
+        if (blocks[i] != air && idToIndex[blocks[i]] == 0) {
+            idToIndex[blocks[i]] = palette.size();
+            palette.push_back(blocks[i]);
+        }
+    }
+    if (palette.size() == 1) return; // Only air
+    if (palette.size() > 256) throw runtime_error("Too many block IDs in a chunk");
+    bits = palette.size() <= 2 ? 1 : palette.size() <= 4 ? 2 : palette.size() <= 16 ? 4 : 8;
+
+    // Pack the indices
+    data.assign(size * size * size * bits / 64, 0);
+    for (uint32_t z = 0; z < size; z++) {
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                int16_t id = blocks[x + y * size + z * size * size];
+                if (id == air) continue;
+                uint32_t bit = ((y + z * size) * size + x) * bits;
+                data[bit / 64] |= (uint64_t)idToIndex[id] << (bit % 64);
+            }
+        }
+    }
+}
+
+
+uint64_t PalettedChunk::solidRow(uint32_t y, uint32_t z) const {
+    if (bits == 0) return 0;
+    uint32_t bit = (y + z * size) * size * bits;
+    if (size * bits < 64) return nonZeroFields(data[bit / 64] >> (bit % 64), bits) & ((1ull << size) - 1); // Half a word (32 blocks, 1 bit)
+    const uint64_t* row = data.data() + bit / 64;
+    uint64_t solid = 0;
+    for (uint32_t word = 0; word < size * bits / 64; word++) {
+        solid |= nonZeroFields(row[word], bits) << (word * 64 / bits);
+    }
+    return solid;
+}
+
+
+size_t PalettedChunk::memorySize() const {
+    return sizeof(PalettedChunk) + palette.capacity() * sizeof(int16_t) + data.capacity() * sizeof(uint64_t);
+}
+
+
+// Bit i of the result is 1 if bits [i * bits, (i + 1) * bits[ of word are not all 0
+inline uint64_t nonZeroFields(uint64_t word, uint32_t bits) {
+    switch (bits) {
+    case 1:
+        return word;
+    case 2:
+        word = (word | word >> 1) & 0x5555555555555555;
+#ifdef __BMI2__
+        return _pext_u64(word, 0x5555555555555555);
+#else
+        word = (word | word >> 1) & 0x3333333333333333;
+        word = (word | word >> 2) & 0x0f0f0f0f0f0f0f0f;
+        word = (word | word >> 4) & 0x00ff00ff00ff00ff;
+        word = (word | word >> 8) & 0x0000ffff0000ffff;
+        return (word | word >> 16) & 0x00000000ffffffff;
+#endif
+    case 4:
+        word |= word >> 1;
+        word = (word | word >> 2) & 0x1111111111111111;
+#ifdef __BMI2__
+        return _pext_u64(word, 0x1111111111111111);
+#else
+        word = (word | word >> 3) & 0x0303030303030303;
+        word = (word | word >> 6) & 0x000f000f000f000f;
+        word = (word | word >> 12) & 0x000000ff000000ff;
+        return (word | word >> 24) & 0x000000000000ffff;
+#endif
+    default:
+        word |= word >> 1;
+        word |= word >> 2;
+        word = (word | word >> 4) & 0x0101010101010101;
+#ifdef __BMI2__
+        return _pext_u64(word, 0x0101010101010101);
+#else
+        word = (word | word >> 7) & 0x0003000300030003;
+        word = (word | word >> 14) & 0x0000000f0000000f;
+        return (word | word >> 28) & 0x00000000000000ff;
+#endif
+    }
+}
+
+
+
+PalettedChunks::PalettedChunks(const WorldConfig& world, const int* IDs, const uint32_t* IDIndexes, uint32_t threadCount) :
+    world(world) {
+    convertColumns(world, chunks, threadCount, [&](uint32_t xzIndex, auto addBlocks) {
+        for (uint32_t i = IDIndexes[xzIndex]; i < IDIndexes[xzIndex + 1]; i += 2) addBlocks(IDs[i], IDs[i] + 1, IDs[i + 1]);
+    });
+}
+
+
+PalettedChunks::PalettedChunks(const CompactColumns& columns, uint32_t threadCount) :
+    world(columns.world) {
+    convertColumns(world, chunks, threadCount, [&](uint32_t xzIndex, auto addBlocks) {
+        uint32_t start = columns.index.start(xzIndex);
+        uint32_t end = columns.index.end(xzIndex);
+        if (start == end) return;
+        addBlocks(columns.bottoms[xzIndex], columns.ys[start], 0);
+        for (uint32_t i = start; i < end; i++) addBlocks(columns.ys[i], columns.ys[i] + 1, columns.ids[i]);
+    });
+}
+
+
+size_t PalettedChunks::memorySize() const {
+    size_t size = 0;
+    for (const PalettedChunk& chunk : chunks) size += chunk.memorySize();
+    return size;
+}
+
+
+// Convert all columns of each chunk column (addBlocks(xzIndex, add) must call add(startY, endY, id) for all blocks of column xzIndex)
+template<typename AddBlocks> void convertColumns(const WorldConfig& world, vector<PalettedChunk>& chunks, uint32_t threadCount, AddBlocks addBlocks) {
+    if (threadCount == 0) threadCount = defaultThreadCount();
+    int size = world.chunkSize;
+    int chunkBlocks = size * size * size;
+    chunks.resize(world.horizontalChunks * world.horizontalChunks * world.verticalChunks);
+    vector<vector<int16_t>> threadBlocks(threadCount);
+    parallelFor(world.horizontalChunks * world.horizontalChunks, threadCount, [&](uint32_t chunk, uint32_t thread) {
+        // All blocks of the chunk column (index of (x, y, z) : x + y * size + z * size^2 + chunkY * size^3)
+        vector<int16_t>& blocks = threadBlocks[thread];
+        if (blocks.empty()) blocks.assign(chunkBlocks * world.verticalChunks, PalettedChunk::air);
+        vector<bool> filled(world.verticalChunks, false);
+        for (int z = 0; z < size; z++) {
+            for (int x = 0; x < size; x++) {
+                addBlocks(chunk * size * size + x + z * size, [&](int startY, int endY, int id) {
+                    for (int y = max(startY, 0); y < min(endY, world.verticalSize); y++) {
+                        blocks[x + y % size * size + z * size * size + y / size * chunkBlocks] = id;
+                        filled[y / size] = true;
+                    }
+                });
+            }
+        }
+
+        // Only chunks with blocks need to be converted, then cleared for the next chunk column
+        for (int chunkY = 0; chunkY < world.verticalChunks; chunkY++) {
+            if (!filled[chunkY]) {
+                chunks[chunkY + chunk * world.verticalChunks] = PalettedChunk(size);
+                continue;
+            }
+            int16_t* levelBlocks = blocks.data() + chunkY * chunkBlocks;
+            chunks[chunkY + chunk * world.verticalChunks] = PalettedChunk(size, levelBlocks);
+            fill(levelBlocks, levelBlocks + chunkBlocks, PalettedChunk::air);
+        }
+    });
+}
@@ -0,0 +1,34 @@
+#include "Parallel.hpp"
+
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+
+uint32_t defaultThreadCount() {
+    uint32_t count = thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+
+void parallelFor(uint32_t count, uint32_t threadCount, const function<void(uint32_t index, uint32_t thread)>& function) {
+    if (threadCount == 0) threadCount = defaultThreadCount();
+    if (threadCount > count) threadCount = count;
+    if (threadCount <= 1) { // No need to start threads
+        for (uint32_t i = 0; i < count; i++) function(i, 0);
+        return;
+    }
+
+    atomic<uint32_t> next(0);
+    auto work = [&](uint32_t thread) {
+        for (uint32_t i = next++; i < count; i = next++) function(i, thread);
+    };
+    vector<std::thread> threads;
+    for (uint32_t thread = 1; thread < threadCount; thread++) threads.emplace_back(work, thread);
+    work(0);
+    for (std::thread& thread : threads) thread.join();
+}
@@ -0,0 +1,59 @@
+#include "PublishedColumns.hpp"
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+#include "CompactColumns.hpp"
+#include "ChunkedColumns.hpp"
+#include "WorldConfig.hpp"
+
+using namespace std;
+
+
+PublishedColumns::PublishedColumns(const ChunkedColumns& columns, uint32_t readerCount) :
+    world(columns.world),
+    chunks(new atomic<const CompactColumns*>[world.horizontalChunks * world.horizontalChunks]),
+    current(world.horizontalChunks * world.horizontalChunks),
+    readers(new ReaderEpoch[readerCount]),
+    readerCount(readerCount),
+    epoch(0) {
+    for (uint32_t chunk = 0; chunk < current.size(); chunk++) {
+        current[chunk] = columns.shareChunk(chunk);
+        chunks[chunk].store(current[chunk].get());
+    }
+}
+
+
+// Readers that loaded a replaced pointer started reading before the epoch is incremented (pointers are stored before),
+// so they read an epoch at most equal to the epoch the pointer is replaced in
+uint32_t PublishedColumns::publish(const ChunkedColumns& columns) {
+    if (!(columns.world == world)) throw runtime_error("Columns of another world");
+    uint64_t replaceEpoch = epoch.load();
+    uint32_t replaced = 0;
+    for (uint32_t chunk = 0; chunk < current.size(); chunk++) {
+        if (&columns.chunk(chunk) == current[chunk].get()) continue;
+        shared_ptr<const CompactColumns> next = columns.shareChunk(chunk);
+        chunks[chunk].store(next.get());
+        retired.push_back(RetiredChunk { replaceEpoch, move(current[chunk]) });
+        current[chunk] = move(next);
+        replaced++;
+    }
+    epoch.store(replaceEpoch + 1);
+    reclaim();
+    return replaced;
+}
+
+
+// Chunk columns are retired in epoch order, the ones replaced before the oldest epoch still read are released
+void PublishedColumns::reclaim() {
+    uint64_t oldestEpoch = notReading;
+    for (uint32_t reader = 0; reader < readerCount; reader++) oldestEpoch = min(oldestEpoch, readers[reader].epoch.load());
+    uint32_t released = 0;
+    while (released < retired.size() && retired[released].epoch < oldestEpoch) released++;
+    retired.erase(retired.begin(), retired.begin() + released);
+}
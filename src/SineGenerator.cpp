@@ -0,0 +1,17 @@
+#include "SineGenerator.hpp"
+
+#include <cmath>
+
+
+static constexpr int amplitude = 80;
+static constexpr int blockPeriod = 500;
+static constexpr int idHeight = 50;
+
+
+void SineGenerator::generate(int startX, int z, int count, int* heights, int* ids) const {
+    for (int x = startX; x < startX + count; x++) {
+        int height = 1 + (int)(amplitude * (sin(2 * M_PI * x / blockPeriod) * sin(2 * M_PI * z / blockPeriod) + 1));
+        *heights++ = height;
+        *ids++ = height / idHeight + 1;
+    }
+}
@@ -0,0 +1,18 @@
+#include "TerrainGenerator.hpp"
+
+#include <chrono>
+
+using namespace std;
+using namespace chrono;
+
+
+double TerrainGenerator::benchmark(int size) const {
+    int* heights = new int[size];
+    int* ids = new int[size];
+    steady_clock::time_point start = steady_clock::now();
+    for (int z = 0; z < size; z++) generate(0, z, size, heights, ids);
+    double seconds = duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1e9;
+    delete[] heights;
+    delete[] ids;
+    return (double)size * size / seconds / 1e6;
+}
@@ -1,11 +1,17 @@
 #include "TerrainRenderer.hpp"
 
+#include <cstdint>
 #include <cstdlib>
 #include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
 
 #include "GLObjects/OpenGL.hpp"
 #include "Camera.hpp"
 #include "VoxelMesh.hpp"
+#include "MeshSink.hpp"
+#include "WorldConfig.hpp"
 
 using namespace gl;
 using namespace glm;
@@ -14,11 +20,28 @@ using namespace std;
 
 static constexpr int threadGroupSize = 64; // Number of threads in a work group for the compute shader
 static constexpr float quadsInterleaving = 0.05f; // Remove small (1 pixel) gaps between triangles
+static constexpr float lodDistance = 512; // Distance of the first downsampled level of detail, each next level starts twice as far
+static constexpr uint32_t updateReserve = 8; // Room for replaced meshes in the buffers (1 / updateReserve of the first meshes)
 
+uint32_t roundToGroups(uint32_t meshCount);
 
-TerrainRenderer::TerrainRenderer(Camera& camera) :
+
+RendererUpdateSink::RendererUpdateSink(TerrainRenderer& renderer) :
+    renderer(renderer) {
+}
+
+
+void RendererUpdateSink::addMeshes(uint32_t chunkX, uint32_t chunkZ, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) {
+    renderer.replaceMeshes(chunkX, chunkZ, meshes, meshCount, squares, squareCount);
+}
+
+
+TerrainRenderer::TerrainRenderer(Camera& camera, const WorldConfig& world, bool levelsOfDetail) :
     camera(camera),
+    world(world),
     shader("shaders/vertex.glsl", "shaders/fragment.glsl"),
+    sink(meshData, squares),
+    update(*this),
     graphicsPositionUniform(shader, "position"),
     vpMatrixUniform(shader, "vpMatrix"),
     frustumCulling("shaders/frustumCulling.glsl"),
@@ -27,9 +50,17 @@ TerrainRenderer::TerrainRenderer(Camera& camera) :
     leftPlaneUniform(frustumCulling, "leftPlane"),
     rightPlaneUniform(frustumCulling, "rightPlane"),
     upPlaneUniform(frustumCulling, "upPlane"),
-    downPlaneUniform(frustumCulling, "downPlane") {
+    downPlaneUniform(frustumCulling, "downPlane"),
+    meshCount(0),
+    meshEnd(0),
+    meshCapacity(0),
+    squareCount(0),
+    squareCapacity(0),
+    workGroups(0) {
     Uniform(shader, "seed").setValue(shader, rand() / (float)RAND_MAX);
     Uniform(shader, "quadsInterleaving").setValue(shader, quadsInterleaving);
+    Uniform(frustumCulling, "chunkSize").setValue(frustumCulling, (float)world.chunkSize);
+    Uniform(frustumCulling, "lodDistance").setValue(frustumCulling, levelsOfDetail ? lodDistance : numeric_limits<float>::max());
     vertexArray.use();
     commandsBuffer.use(BufferType::indirectDraw);
     paramsBuffer.use(BufferType::parameters);
@@ -40,36 +71,69 @@ TerrainRenderer::TerrainRenderer(Camera& camera) :
 
 
 void TerrainRenderer::addMeshes(const vector<VoxelMesh>& meshes, const vector<Square>& squares) {
-    uint32_t startSquare = this->squares.size();
-    for (VoxelMesh mesh : meshes) {
-        meshData.push_back(MeshData(mesh, startSquare));
-        startSquare += mesh.squaresCount;
-    }
-    this->squares.insert(this->squares.end(), squares.begin(), squares.end());
+    sink.addMeshes(meshes.data(), meshes.size(), squares.data(), squares.size());
 }
 
 
 void TerrainRenderer::prepareRender() {
     // Add empty meshes at the end to have a size multiple of THREAD_GROUP_SIZE
     while (meshData.size() % threadGroupSize != 0) meshData.push_back(MeshData(vec3(0), vec3(0), CubeNormal::xPositive, 0, 0));
-    workGroups = meshData.size() / threadGroupSize;
-
-    // Create buffers
-    squaresBuffer.setDataUnique(squares.data(), squares.size(), UniqueBufferUsage::none);
-    IndirectDrawArgs* commands = new IndirectDrawArgs[meshData.size()];
-    fill(commands, commands + meshData.size(), IndirectDrawArgs { 4, 0, 0, 0 });
-    commandsBuffer.setDataUnique(commands, meshData.size(), UniqueBufferUsage::none);
-    delete[] commands;
-    meshDataBuffer.setDataUnique(meshData.data(), meshData.size(), UniqueBufferUsage::none);
+    prepareRender(meshData.data(), meshData.size(), squares.data(), squares.size());
+}
+
+
+void TerrainRenderer::prepareRender(const MeshData* meshData, uint32_t meshCount, const Square* squares, uint32_t squareCount) {
+    if (meshCount % threadGroupSize != 0) throw runtime_error("Mesh count must be a multiple of the work group size");
+    findChunkMeshes(meshData, meshCount);
+
+    // Create buffers, with room for replaced meshes (see replaceMeshes())
+    meshEnd = 0;
+    this->squareCount = 0;
+    reserve(meshCount + meshCount / updateReserve, squareCount + squareCount / updateReserve);
+    squaresBuffer.modifyData(squares, squareCount);
+    meshDataBuffer.modifyData(meshData, meshCount);
+    meshEnd = meshCount;
+    this->meshCount = meshCount;
+    this->squareCount = squareCount;
+    workGroups = meshCount / threadGroupSize;
     paramsBuffer.setDataUnique<uint32_t>(nullptr, 1, UniqueBufferUsage::none);
 
     // Create vertex array
-    vertexArray.setBuffer(0, squaresBuffer, 2 * sizeof(uint32_t), 0, 1);
     vertexArray.setAttributeFormat(0, IntAttributeType::uint32, 2, 0);
     vertexArray.setAttributeBuffer(0, 0);
 }
 
 
+void TerrainRenderer::replaceMeshes(uint32_t chunkX, uint32_t chunkZ, const VoxelMesh* meshes, uint32_t meshCount, const Square* squares, uint32_t squareCount) {
+    if (chunkMeshes.empty()) throw runtime_error("Meshes can only be replaced after prepareRender()");
+    ChunkMeshes& chunk = chunkMeshes[chunkX + chunkZ * world.horizontalChunks];
+    if (meshCount > chunk.meshCapacity || squareCount > chunk.squareCapacity) {
+        // Move the chunk column after all chunk columns, with room to grow (its old mesh slots stay empty)
+        if (chunk.meshCapacity != 0) meshDataBuffer.clearData(chunk.meshCapacity * sizeof(MeshData), chunk.meshStart * sizeof(MeshData));
+        chunk.meshCapacity = meshCount + meshCount / 2 + 6;
+        chunk.squareCapacity = squareCount + squareCount / 2;
+        reserve(meshEnd + chunk.meshCapacity, this->squareCount + chunk.squareCapacity);
+        chunk.meshStart = meshEnd;
+        chunk.squareStart = this->squareCount;
+        meshEnd += chunk.meshCapacity;
+        this->squareCount += chunk.squareCapacity;
+        this->meshCount = roundToGroups(meshEnd);
+        workGroups = this->meshCount / threadGroupSize;
+    }
+
+    // Upload the meshes of the chunk column and empty meshes in its other slots
+    updatedMeshes.clear();
+    uint32_t start = chunk.squareStart;
+    for (uint32_t i = 0; i < meshCount; i++) {
+        updatedMeshes.push_back(MeshData(meshes[i], start));
+        start += meshes[i].squaresCount;
+    }
+    while (updatedMeshes.size() < chunk.meshCapacity) updatedMeshes.push_back(MeshData(vec3(0), vec3(0), CubeNormal::xPositive, 0, 0));
+    meshDataBuffer.modifyData(updatedMeshes.data(), updatedMeshes.size(), chunk.meshStart);
+    squaresBuffer.modifyData(squares, squareCount, chunk.squareStart);
+}
+
+
 void TerrainRenderer::render() {
     // Frustum culling
     frustumPositionUniform.setValue(frustumCulling, camera.position);
@@ -87,5 +151,64 @@ void TerrainRenderer::render() {
     graphicsPositionUniform.setValue(shader, camera.position);
     vpMatrixUniform.setValue(shader, camera.vpMatrix);
     shader.use();
-    drawIndirectParam(GeometryMode::triangleStrip, meshData.size());
+    drawIndirectParam(GeometryMode::triangleStrip, meshCount);
+}
+
+
+// Meshes are in chunk order and the squares of a chunk column are after each other (see GenerateMesh.hpp),
+// the chunk column of a mesh is the chunk column of the lowest corner of its squares
+void TerrainRenderer::findChunkMeshes(const MeshData* meshData, uint32_t meshCount) {
+    chunkMeshes.assign(world.horizontalChunks * world.horizontalChunks, ChunkMeshes { 0, 0, 0, 0 });
+    for (uint32_t i = 0; i < meshCount; i++) {
+        const MeshData& mesh = meshData[i];
+        uint32_t normal = mesh.data1 & 7;
+        uint32_t lod = (mesh.data1 >> 3) & 3;
+        uint32_t meshSquares = mesh.data1 >> 5;
+        if (meshSquares == 0) continue; // Padding
+        vec3 corner = mesh.center - mesh.size;
+        corner[axis((CubeNormal)normal)] -= normalPositive((CubeNormal)normal) << lod; // Meshes with a positive normal start one cell after their chunk (see VoxelMesh)
+        ChunkMeshes& chunk = chunkMeshes[(uint32_t)corner.x / world.chunkSize + (uint32_t)corner.z / world.chunkSize * world.horizontalChunks];
+        if (chunk.meshCapacity == 0) {
+            chunk.meshStart = i;
+            chunk.squareStart = mesh.data2;
+        }
+        chunk.meshCapacity++;
+        chunk.squareCapacity += meshSquares;
+    }
+}
+
+
+// Grow the buffers to at least the given sizes, keeping the used part
+void TerrainRenderer::reserve(uint32_t meshes, uint32_t squares) {
+    if (squares > squareCapacity) {
+        uint32_t capacity = max(squares, squareCapacity + squareCapacity / 2);
+        Buffer buffer;
+        buffer.setDataUnique<Square>(nullptr, capacity, UniqueBufferUsage::dynamicStorage);
+        if (squareCount != 0) buffer.copyData<Square>(squaresBuffer, squareCount);
+        squaresBuffer = move(buffer);
+        squareCapacity = capacity;
+        vertexArray.setBuffer(0, squaresBuffer, 2 * sizeof(uint32_t), 0, 1);
+    }
+    if (meshes > meshCapacity) {
+        uint32_t capacity = roundToGroups(max(meshes, meshCapacity + meshCapacity / 2));
+        Buffer buffer;
+        buffer.setDataUnique<MeshData>(nullptr, capacity, UniqueBufferUsage::dynamicStorage);
+        buffer.clearData(); // Empty meshes
+        if (meshEnd != 0) buffer.copyData<MeshData>(meshDataBuffer, meshEnd);
+        meshDataBuffer = move(buffer);
+        meshDataBuffer.use(ShaderBufferType::storage, 0);
+        IndirectDrawArgs* commands = new IndirectDrawArgs[capacity];
+        fill(commands, commands + capacity, IndirectDrawArgs { 4, 0, 0, 0 });
+        commandsBuffer = Buffer();
+        commandsBuffer.setDataUnique(commands, capacity, UniqueBufferUsage::none);
+        delete[] commands;
+        commandsBuffer.use(BufferType::indirectDraw);
+        commandsBuffer.use(ShaderBufferType::storage, 1);
+        meshCapacity = capacity;
+    }
+}
+
+
+uint32_t roundToGroups(uint32_t meshCount) {
+    return (meshCount + threadGroupSize - 1) / threadGroupSize * threadGroupSize;
 }
\ No newline at end of file
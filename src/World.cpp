@@ -0,0 +1,561 @@
+#include "World.hpp"
+
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+#include "CompactColumns.hpp"
+#include "ChunkedColumns.hpp"
+#include "GenerateMesh.hpp"
+#include "MeshSink.hpp"
+#include "MeshingContext.hpp"
+#include "WorldConfig.hpp"
+
+using namespace std;
+using namespace glm;
+
+static constexpr int maxFills = 2; // Fills of a column by a brush
+static constexpr int horizontalNeighbours[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+static constexpr int hidden = -2; // Solid block that is not stored, in expanded columns (see World.hpp)
+static constexpr int windowMargin = 2; // Columns expanded around the edited rectangle (blocks exposed by the edit, and hidden blocks next to them)
+static constexpr int windowRows = 4; // Rows of columns expanded at the same time by an edit
+static constexpr uint8_t removedBlock = 1; // Flag of a block replaced with air by the edit
+static constexpr uint8_t revealedBlock = 2; // Flag of a block visible after the edit and not before
+static constexpr uint8_t facesChanged = 1; // Change of a column: blocks with faces
+static constexpr uint8_t hiddenStored = 2; // Change of a column: hidden blocks stored
+
+void moveColumns(CompactColumns& columns, const EditedColumn* edited, uint32_t count, const vector<uint16_t>& editedYs, const vector<uint8_t>& editedIDs);
+bool insideWorld(const WorldConfig& world, int x, int y, int z);
+
+
+World::World(const CompactColumnsView& columns, ExposedBlockID exposedBlockID) :
+    blocks(columns),
+    exposedBlockID(exposedBlockID),
+    dirtyFlags(blocks.world.horizontalChunks * blocks.world.horizontalChunks, false) {
+}
+
+
+World::World(const ChunkedColumns& columns, ExposedBlockID exposedBlockID) :
+    blocks(columns),
+    exposedBlockID(exposedBlockID),
+    dirtyFlags(blocks.world.horizontalChunks * blocks.world.horizontalChunks, false) {
+}
+
+
+int World::block(int x, int y, int z) const {
+    if (!insideWorld(blocks.world, x, y, z)) throw runtime_error("Block outside of the world");
+    const CompactColumns& columns = blocks.chunk(chunkIndex(x, z));
+    uint32_t xzIndex = columnIndex(x, z);
+    uint32_t start = columns.index.start(xzIndex);
+    uint32_t end = columns.index.end(xzIndex);
+    if (start == end) return air;
+    int bottom = columns.bottoms[xzIndex];
+    if (y < columns.ys[start]) {
+        if (y >= bottom) return 0; // Invisible blocks below the first block
+        return bottom < columns.ys[start] || columns.ids[start] == 0 ? 0 : air; // Hidden blocks below an invisible lowest block
+    }
+    const uint16_t* found = lower_bound(columns.ys.data() + start, columns.ys.data() + end, y);
+    if (found == columns.ys.data() + end) return air;
+    if (*found == y) return columns.ids[found - columns.ys.data()];
+    return columns.ids[found - 1 - columns.ys.data()] == 0 ? 0 : air; // Hidden blocks above an invisible block
+}
+
+
+void World::setBlock(int x, int y, int z, int id) {
+    if (!insideWorld(blocks.world, x, y, z)) throw runtime_error("Block outside of the world");
+    if (id < 1 || id > 255) throw runtime_error("Invalid block ID");
+    fillBox(ivec3(x, y, z), ivec3(x, y, z), id);
+}
+
+
+void World::removeBlock(int x, int y, int z) {
+    if (!insideWorld(blocks.world, x, y, z)) throw runtime_error("Block outside of the world");
+    fillBox(ivec3(x, y, z), ivec3(x, y, z), air);
+}
+
+
+void World::fillBox(ivec3 min, ivec3 max, int id) {
+    if (id != air && (id < 1 || id > 255)) throw runtime_error("Invalid block ID");
+    edit(min.x, min.z, max.x + 1, max.z + 1, [&](int, int, ColumnFill* fills) {
+        fills[0] = ColumnFill { min.y, max.y, id };
+        return 1;
+    });
+}
+
+
+void World::fillSphere(ivec3 center, int radius, int id) {
+    if (id != air && (id < 1 || id > 255)) throw runtime_error("Invalid block ID");
+    edit(center.x - radius, center.z - radius, center.x + radius + 1, center.z + radius + 1, [&](int x, int z, ColumnFill* fills) {
+        int dx = x - center.x;
+        int dz = z - center.z;
+        int squaredHeight = radius * radius - dx * dx - dz * dz;
+        if (squaredHeight < 0) return 0;
+        int height = std::sqrt((double)squaredHeight);
+        while (height * height > squaredHeight) height--;
+        while ((height + 1) * (height + 1) <= squaredHeight) height++;
+        fills[0] = ColumnFill { center.y - height, center.y + height, id };
+        return 1;
+    });
+}
+
+
+void World::stampHeights(int startX, int startZ, int sizeX, int sizeZ, const int* heights, int id) {
+    if (id < 1 || id > 255) throw runtime_error("Invalid block ID");
+    for (int i = 0; i < sizeX * sizeZ; i++) {
+        if (heights[i] < 0 || heights[i] >= blocks.world.verticalSize) throw runtime_error("Invalid height");
+    }
+    auto height = [&](int x, int z) { // Height of a column after the edit
+        if (x >= startX && z >= startZ && x < startX + sizeX && z < startZ + sizeZ) return heights[x - startX + (z - startZ) * sizeX];
+        return columnTop(x, z);
+    };
+    edit(startX, startZ, startX + sizeX, startZ + sizeZ, [&](int x, int z, ColumnFill* fills) {
+        int top = height(x, z);
+        int bottom = top;
+        for (const int* offset : horizontalNeighbours) {
+            int neighbourX = x + offset[0];
+            int neighbourZ = z + offset[1];
+            if (insideWorld(blocks.world, neighbourX, 0, neighbourZ)) bottom = std::min(bottom, height(neighbourX, neighbourZ) + 1);
+        }
+        fills[0] = ColumnFill { bottom, top, id };
+        fills[1] = ColumnFill { top + 1, blocks.world.verticalSize - 1, air };
+        return 2;
+    });
+}
+
+
+// Step through the blocks crossed by the ray (one axis at a time, to the closest block boundary)
+bool World::raycast(vec3 origin, vec3 direction, float maxDistance, ivec3& hit, ivec3& before) const {
+    ivec3 current = (ivec3)floor(origin);
+    ivec3 step;
+    vec3 nextBoundary; // Distance along the ray to the next block boundary on each axis
+    vec3 boundaryDistance; // Distance along the ray between two block boundaries on each axis
+    for (int axis = 0; axis < 3; axis++) {
+        step[axis] = direction[axis] > 0 ? 1 : -1;
+        if (direction[axis] == 0) {
+            nextBoundary[axis] = INFINITY;
+            boundaryDistance[axis] = INFINITY;
+        }
+        else {
+            float boundary = direction[axis] > 0 ? current[axis] + 1 : current[axis];
+            nextBoundary[axis] = (boundary - origin[axis]) / direction[axis];
+            boundaryDistance[axis] = step[axis] / direction[axis];
+        }
+    }
+
+    before = current;
+    float distance = 0;
+    while (distance <= maxDistance) {
+        if (insideWorld(blocks.world, current.x, current.y, current.z) && block(current.x, current.y, current.z) != air) {
+            hit = current;
+            return true;
+        }
+        before = current;
+        int axis = nextBoundary.x < nextBoundary.y ? (nextBoundary.x < nextBoundary.z ? 0 : 2) : (nextBoundary.y < nextBoundary.z ? 1 : 2);
+        current[axis] += step[axis];
+        distance = nextBoundary[axis];
+        nextBoundary[axis] += boundaryDistance[axis];
+    }
+    return false;
+}
+
+
+// The chunk columns that are not shared with the snapshot changed, their neighbours can have changed faces on their border
+void World::restore(const ChunkedColumns& snapshot) {
+    if (!(snapshot.world == blocks.world)) throw runtime_error("Snapshot of another world");
+    int horizontalChunks = blocks.world.horizontalChunks;
+    for (int chunkZ = 0; chunkZ < horizontalChunks; chunkZ++) {
+        for (int chunkX = 0; chunkX < horizontalChunks; chunkX++) {
+            uint32_t chunk = chunkX + chunkZ * horizontalChunks;
+            if (blocks.sharesChunk(snapshot, chunk)) continue;
+            markDirty(chunk);
+            if (chunkX > 0) markDirty(chunk - 1);
+            if (chunkX < horizontalChunks - 1) markDirty(chunk + 1);
+            if (chunkZ > 0) markDirty(chunk - horizontalChunks);
+            if (chunkZ < horizontalChunks - 1) markDirty(chunk + horizontalChunks);
+        }
+    }
+    blocks = snapshot;
+}
+
+
+void World::remesh(MeshSink& sink, MeshingContext& context) {
+    int horizontalChunks = blocks.world.horizontalChunks;
+    for (uint32_t chunk : dirty) {
+        generateMesh(chunk % horizontalChunks, chunk / horizontalChunks, 1, 1, blocks, sink, context, 1);
+        dirtyFlags[chunk] = false;
+    }
+    dirty.clear();
+}
+
+
+uint32_t World::chunkIndex(int x, int z) const {
+    return x / blocks.world.chunkSize + z / blocks.world.chunkSize * blocks.world.horizontalChunks;
+}
+
+
+// Index of a column in its chunk column
+uint32_t World::columnIndex(int x, int z) const {
+    return x % blocks.world.chunkSize + z % blocks.world.chunkSize * blocks.world.chunkSize;
+}
+
+
+// Highest block of a column (-1 if it is empty)
+int World::columnTop(int x, int z) const {
+    const CompactColumns& columns = blocks.chunk(chunkIndex(x, z));
+    uint32_t xzIndex = columnIndex(x, z);
+    uint32_t start = columns.index.start(xzIndex);
+    uint32_t end = columns.index.end(xzIndex);
+    return start == end ? -1 : columns.ys[end - 1];
+}
+
+
+// Expand the columns of the rectangle and the columns around it row by row (one block per y, see windowBlocks), then replace the blocks of the fills.
+// One row later (once the rows around it are filled) the blocks next to removed blocks become visible, and one more row later
+// the hidden blocks next to blocks that became visible are stored, then the changed columns of the row are rewritten.
+// All rewritten columns are moved to the columns at once.
+// brush(x, z, fills) gives the fills of a column of the rectangle and returns their number (at most maxFills).
+template<typename Brush> void World::edit(int startX, int startZ, int endX, int endZ, const Brush& brush) {
+    const WorldConfig& world = blocks.world;
+    startX = std::max(startX, 0);
+    startZ = std::max(startZ, 0);
+    endX = std::min(endX, world.horizontalSize);
+    endZ = std::min(endZ, world.horizontalSize);
+    if (startX >= endX || startZ >= endZ) return;
+    EditWindow window {
+        std::max(startX - windowMargin, 0),
+        std::max(startZ - windowMargin, 0),
+        std::min(endX + windowMargin, world.horizontalSize),
+        std::min(endZ + windowMargin, world.horizontalSize)
+    };
+    uint32_t windowSize = windowRows * (window.endX - window.startX);
+    windowColumns.resize(windowSize);
+    windowBlocks.resize(windowSize * world.verticalSize);
+    windowFlags.resize(windowSize * world.verticalSize);
+    windowIDs.resize(windowSize * world.verticalSize);
+    edited.clear();
+    editedYs.clear();
+    editedIDs.clear();
+
+    ColumnFill fills[maxFills];
+    for (int z = window.startZ; z < window.endZ + 2; z++) {
+        if (z < window.endZ) {
+            for (int x = window.startX; x < window.endX; x++) {
+                int fillCount = 0;
+                if (x >= startX && z >= startZ && x < endX && z < endZ) {
+                    fillCount = brush(x, z, fills);
+                    for (int i = 0; i < fillCount; i++) { // Clipped to the world
+                        fills[i].start = std::max(fills[i].start, 0);
+                        fills[i].end = std::min(fills[i].end, world.verticalSize - 1);
+                    }
+                }
+                expandColumn(window, x, z, fills, fillCount);
+            }
+        }
+        if (z - 1 >= window.startZ && z - 1 < window.endZ) exposeRow(window, z - 1);
+        if (z - 2 >= window.startZ) {
+            coverRow(window, z - 2);
+            storeRow(window, z - 2);
+        }
+    }
+    applyEdits();
+}
+
+
+// Index of an expanded column in windowColumns (rows are reused every windowRows rows)
+uint32_t World::windowColumn(const EditWindow& window, int x, int z) const {
+    return z % windowRows * (window.endX - window.startX) + x - window.startX;
+}
+
+
+// Expand a column to one block per y (stored blocks, invisible blocks below the first one, hidden blocks and air), then replace the blocks of its fills
+void World::expandColumn(const EditWindow& window, int x, int z, const ColumnFill* fills, int fillCount) {
+    int verticalSize = blocks.world.verticalSize;
+    uint32_t index = windowColumn(window, x, z);
+    ExpandedColumn& expanded = windowColumns[index];
+    int16_t* column = windowBlocks.data() + index * verticalSize;
+    uint8_t* flags = windowFlags.data() + index * verticalSize;
+    uint8_t* removedIDs = windowIDs.data() + index * verticalSize;
+    expanded = ExpandedColumn { 0, verticalSize, 0, verticalSize, 0 };
+    fill(flags, flags + verticalSize, 0);
+
+    const CompactColumns& columns = blocks.chunk(chunkIndex(x, z));
+    uint32_t xzIndex = columnIndex(x, z);
+    uint32_t start = columns.index.start(xzIndex);
+    uint32_t end = columns.index.end(xzIndex);
+    fill(column, column + verticalSize, air);
+    if (start != end) {
+        int bottom = columns.bottoms[xzIndex];
+        int first = columns.ys[start];
+        if (bottom < first || columns.ids[start] == 0) fill(column, column + bottom, hidden);
+        fill(column + bottom, column + first, 0);
+        for (uint32_t i = start; i < end; i++) {
+            column[columns.ys[i]] = columns.ids[i];
+            if (columns.ids[i] == 0 && i + 1 < end) fill(column + columns.ys[i] + 1, column + columns.ys[i + 1], hidden);
+        }
+    }
+
+    for (int i = 0; i < fillCount; i++) {
+        const ColumnFill& columnFill = fills[i];
+        for (int y = columnFill.start; y <= columnFill.end; y++) {
+            if (column[y] == columnFill.id) continue;
+            if (columnFill.id == air) {
+                removedIDs[y] = std::max(column[y], (int16_t)0);
+                flags[y] = removedBlock;
+                expanded.removedStart = std::min(expanded.removedStart, y);
+                expanded.removedEnd = std::max(expanded.removedEnd, y + 1);
+            }
+            else if (column[y] <= 0) {
+                flags[y] = revealedBlock;
+                expanded.revealedStart = std::min(expanded.revealedStart, y);
+                expanded.revealedEnd = std::max(expanded.revealedEnd, y + 1);
+            }
+            column[y] = columnFill.id;
+            expanded.changes |= facesChanged;
+        }
+    }
+}
+
+
+// Invisible and hidden blocks next to removed blocks become visible, with the ID of a removed block next to them
+// (or the ID given by exposedBlockID at their height if the removed blocks were not visible either)
+void World::exposeRow(const EditWindow& window, int z) {
+    int verticalSize = blocks.world.verticalSize;
+    for (int x = window.startX; x < window.endX; x++) {
+        uint32_t index = windowColumn(window, x, z);
+        ExpandedColumn& expanded = windowColumns[index];
+        int16_t* column = windowBlocks.data() + index * verticalSize;
+
+        // Columns around, and the blocks next to the removed blocks of the column and of the columns around
+        uint32_t neighbours[4];
+        int neighbourCount = 0;
+        int start = expanded.removedStart - 1;
+        int end = expanded.removedEnd + 1;
+        for (const int* offset : horizontalNeighbours) {
+            int neighbourX = x + offset[0];
+            int neighbourZ = z + offset[1];
+            if (neighbourX < window.startX || neighbourZ < window.startZ || neighbourX >= window.endX || neighbourZ >= window.endZ) continue;
+            uint32_t neighbour = windowColumn(window, neighbourX, neighbourZ);
+            neighbours[neighbourCount++] = neighbour;
+            start = std::min(start, windowColumns[neighbour].removedStart);
+            end = std::max(end, windowColumns[neighbour].removedEnd);
+        }
+
+        for (int y = std::max(start, 0); y < std::min(end, verticalSize); y++) {
+            if (column[y] > 0 || column[y] == air) continue;
+            bool exposed = false;
+            int id = 0;
+            auto check = [&](uint32_t neighbour, int neighbourY) {
+                uint32_t block = neighbour * verticalSize + neighbourY;
+                if ((windowFlags[block] & removedBlock) == 0) return;
+                exposed = true;
+                if (id == 0) id = windowIDs[block];
+            };
+            if (y > 0) check(index, y - 1);
+            if (y < verticalSize - 1) check(index, y + 1);
+            for (int i = 0; i < neighbourCount; i++) check(neighbours[i], y);
+            if (!exposed) continue;
+            if (id == 0) id = exposedBlockID(y, y < verticalSize - 1 && column[y + 1] != air);
+            column[y] = id;
+            windowFlags[index * verticalSize + y] |= revealedBlock;
+            expanded.revealedStart = std::min(expanded.revealedStart, y);
+            expanded.revealedEnd = std::max(expanded.revealedEnd, y + 1);
+            expanded.changes |= facesChanged;
+        }
+    }
+}
+
+
+// Hidden blocks next to blocks that became visible are stored as invisible blocks (so that the visible blocks have no faces on the hidden side)
+void World::coverRow(const EditWindow& window, int z) {
+    int verticalSize = blocks.world.verticalSize;
+    for (int x = window.startX; x < window.endX; x++) {
+        uint32_t index = windowColumn(window, x, z);
+        ExpandedColumn& expanded = windowColumns[index];
+        int16_t* column = windowBlocks.data() + index * verticalSize;
+
+        uint32_t neighbours[4];
+        int neighbourCount = 0;
+        int start = expanded.revealedStart - 1;
+        int end = expanded.revealedEnd + 1;
+        for (const int* offset : horizontalNeighbours) {
+            int neighbourX = x + offset[0];
+            int neighbourZ = z + offset[1];
+            if (neighbourX < window.startX || neighbourZ < window.startZ || neighbourX >= window.endX || neighbourZ >= window.endZ) continue;
+            uint32_t neighbour = windowColumn(window, neighbourX, neighbourZ);
+            neighbours[neighbourCount++] = neighbour;
+            start = std::min(start, windowColumns[neighbour].revealedStart);
+            end = std::max(end, windowColumns[neighbour].revealedEnd);
+        }
+
+        for (int y = std::max(start, 0); y < std::min(end, verticalSize); y++) {
+            if (column[y] != hidden) continue;
+            bool nextToRevealed = (y > 0 && (windowFlags[index * verticalSize + y - 1] & revealedBlock) != 0)
+                || (y < verticalSize - 1 && (windowFlags[index * verticalSize + y + 1] & revealedBlock) != 0);
+            for (int i = 0; i < neighbourCount; i++) nextToRevealed |= (windowFlags[neighbours[i] * verticalSize + y] & revealedBlock) != 0;
+            if (!nextToRevealed) continue;
+            column[y] = 0;
+            expanded.changes |= hiddenStored;
+        }
+    }
+}
+
+
+// Rewrite the changed columns of a row, the chunk columns of the columns with changed faces are marked as edited
+void World::storeRow(const EditWindow& window, int z) {
+    int verticalSize = blocks.world.verticalSize;
+    for (int x = window.startX; x < window.endX; x++) {
+        uint32_t index = windowColumn(window, x, z);
+        if (windowColumns[index].changes == 0) continue;
+        const int16_t* column = windowBlocks.data() + index * verticalSize;
+        columnYs.clear();
+        columnIDs.clear();
+        for (int y = 0; y < verticalSize; y++) {
+            if (column[y] < 0) continue; // Air or hidden
+            columnYs.push_back(y);
+            columnIDs.push_back(column[y]);
+        }
+        storeColumn(chunkIndex(x, z), columnIndex(x, z));
+        if ((windowColumns[index].changes & facesChanged) != 0) markDirty(x, z);
+    }
+}
+
+
+// Add the edited column to the rewritten columns, in the same form as generated columns (see CompactColumns.hpp)
+void World::storeColumn(uint32_t chunk, uint32_t xzIndex) {
+    uint32_t first = 0; // Invisible blocks directly below the next block are not stored
+    while (first + 1 < columnYs.size() && columnIDs[first] == 0 && columnYs[first + 1] == columnYs[first] + 1) first++;
+    uint32_t count = columnYs.size() - first;
+    uint16_t bottom = columnYs.empty() ? 0 : columnYs[0];
+    edited.push_back(EditedColumn { chunk, xzIndex, (uint32_t)editedYs.size(), count, bottom, 0, 0 });
+    editedYs.insert(editedYs.end(), columnYs.begin() + first, columnYs.end());
+    editedIDs.insert(editedIDs.end(), columnIDs.begin() + first, columnIDs.end());
+}
+
+
+// Each edited chunk column is copied if it is shared (with a snapshot), then its rewritten columns are moved to it in one pass
+void World::applyEdits() {
+    if (edited.empty()) return;
+    sort(edited.begin(), edited.end(), [](const EditedColumn& a, const EditedColumn& b) {
+        return a.chunk < b.chunk || (a.chunk == b.chunk && a.xzIndex < b.xzIndex);
+    });
+    uint32_t rowSize = blocks.world.chunkSize;
+
+    // Check that the indices can hold the new starts before changing anything
+    int64_t rowDelta = 0; // Change of size of the rewritten columns before the current one in its row
+    for (uint32_t i = 0; i < edited.size(); i++) {
+        EditedColumn& column = edited[i];
+        const ColumnIndex& index = blocks.chunk(column.chunk).index;
+        column.oldStart = index.start(column.xzIndex);
+        column.oldEnd = index.end(column.xzIndex);
+        if (i > 0 && (edited[i - 1].chunk != column.chunk || edited[i - 1].xzIndex / rowSize != column.xzIndex / rowSize)) rowDelta = 0;
+        if ((column.xzIndex + 1) % rowSize != 0) {
+            rowDelta += (int64_t)column.count - (column.oldEnd - column.oldStart);
+            uint32_t lastColumn = column.xzIndex | (rowSize - 1);
+            if (index.offsets[lastColumn] + rowDelta > UINT16_MAX) throw runtime_error("Too many blocks in a row of columns for the column index");
+        }
+    }
+
+    for (uint32_t first = 0; first < edited.size();) {
+        uint32_t end = first + 1;
+        while (end < edited.size() && edited[end].chunk == edited[first].chunk) end++;
+        moveColumns(blocks.writeChunk(edited[first].chunk), edited.data() + first, end - first, editedYs, editedIDs);
+        first = end;
+    }
+}
+
+
+// The chunk column of the block, and its neighbours if the block is on their border (their faces next to it can change)
+void World::markDirty(int x, int z) {
+    int chunkSize = blocks.world.chunkSize;
+    int horizontalChunks = blocks.world.horizontalChunks;
+    int chunkX = x / chunkSize;
+    int chunkZ = z / chunkSize;
+    auto mark = [&](int markX, int markZ) {
+        if (markX >= 0 && markZ >= 0 && markX < horizontalChunks && markZ < horizontalChunks) markDirty(markX + markZ * horizontalChunks);
+    };
+    mark(chunkX, chunkZ);
+    if (x % chunkSize == 0) mark(chunkX - 1, chunkZ);
+    if (x % chunkSize == chunkSize - 1) mark(chunkX + 1, chunkZ);
+    if (z % chunkSize == 0) mark(chunkX, chunkZ - 1);
+    if (z % chunkSize == chunkSize - 1) mark(chunkX, chunkZ + 1);
+}
+
+
+void World::markDirty(uint32_t chunk) {
+    if (dirtyFlags[chunk]) return;
+    dirtyFlags[chunk] = true;
+    dirty.push_back(chunk);
+}
+
+
+// The blocks between two rewritten columns (edited, sorted, in columns) move by the change of size of the rewritten columns before them:
+// blocks moving to lower indices are moved first in order, then blocks moving to higher indices in reverse order,
+// so that no blocks are written over before they are moved
+void moveColumns(CompactColumns& columns, const EditedColumn* edited, uint32_t count, const vector<uint16_t>& editedYs, const vector<uint8_t>& editedIDs) {
+    ColumnIndex& index = columns.index;
+    uint32_t rowSize = 1 << index.rowShift;
+    uint32_t oldSize = columns.ys.size();
+    int64_t totalDelta = 0;
+    for (uint32_t i = 0; i < count; i++) totalDelta += (int64_t)edited[i].count - (edited[i].oldEnd - edited[i].oldStart);
+    uint32_t newSize = oldSize + totalDelta;
+    if (newSize > oldSize) {
+        columns.ys.resize(newSize);
+        columns.ids.resize(newSize);
+    }
+    auto moveBlocks = [&](uint32_t start, uint32_t end, int64_t shift) {
+        if (shift < 0) {
+            copy(columns.ys.begin() + start, columns.ys.begin() + end, columns.ys.begin() + (start + shift));
+            copy(columns.ids.begin() + start, columns.ids.begin() + end, columns.ids.begin() + (start + shift));
+        }
+        else if (shift > 0) {
+            copy_backward(columns.ys.begin() + start, columns.ys.begin() + end, columns.ys.begin() + (end + shift));
+            copy_backward(columns.ids.begin() + start, columns.ids.begin() + end, columns.ids.begin() + (end + shift));
+        }
+    };
+    int64_t shift = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        shift += (int64_t)edited[i].count - (edited[i].oldEnd - edited[i].oldStart);
+        if (shift < 0) moveBlocks(edited[i].oldEnd, i + 1 < count ? edited[i + 1].oldStart : oldSize, shift);
+    }
+    for (uint32_t i = count; i-- > 0;) {
+        if (shift > 0) moveBlocks(edited[i].oldEnd, i + 1 < count ? edited[i + 1].oldStart : oldSize, shift);
+        shift -= (int64_t)edited[i].count - (edited[i].oldEnd - edited[i].oldStart);
+    }
+
+    // Write the rewritten columns
+    for (uint32_t i = 0; i < count; i++) {
+        const EditedColumn& column = edited[i];
+        copy(editedYs.begin() + column.start, editedYs.begin() + column.start + column.count, columns.ys.begin() + (column.oldStart + shift));
+        copy(editedIDs.begin() + column.start, editedIDs.begin() + column.start + column.count, columns.ids.begin() + (column.oldStart + shift));
+        columns.bottoms[column.xzIndex] = column.bottom;
+        shift += (int64_t)column.count - (column.oldEnd - column.oldStart);
+    }
+    if (newSize < oldSize) {
+        columns.ys.resize(newSize);
+        columns.ids.resize(newSize);
+    }
+
+    // Move the starts of the columns after the rewritten columns
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t delta = edited[i].count - (edited[i].oldEnd - edited[i].oldStart);
+        if (delta == 0) continue;
+        for (uint32_t next = edited[i].xzIndex + 1; next % rowSize != 0; next++) index.offsets[next] += delta;
+    }
+    shift = 0;
+    uint32_t next = 0; // Next rewritten column
+    for (uint32_t row = (edited[0].xzIndex >> index.rowShift) + 1; row < index.rowStarts.size(); row++) {
+        for (; next < count && edited[next].xzIndex < row << index.rowShift; next++) {
+            shift += (int64_t)edited[next].count - (edited[next].oldEnd - edited[next].oldStart);
+        }
+        index.rowStarts[row] += shift;
+    }
+}
+
+
+bool insideWorld(const WorldConfig& world, int x, int y, int z) {
+    return x >= 0 && y >= 0 && z >= 0 && x < world.horizontalSize && y < world.verticalSize && z < world.horizontalSize;
+}
@@ -0,0 +1,19 @@
+#include "WorldConfig.hpp"
+
+#include <stdexcept>
+
+using namespace std;
+
+
+WorldConfig::WorldConfig(int horizontalSize, int verticalSize, int chunkSize) :
+    horizontalSize(horizontalSize),
+    verticalSize(verticalSize),
+    chunkSize(chunkSize),
+    horizontalChunks(horizontalSize / chunkSize),
+    verticalChunks(verticalSize / chunkSize) {
+    if (chunkSize != 32 && chunkSize != 64) throw runtime_error("Chunk size must be 32 or 64");
+    if (horizontalSize <= 0 || horizontalSize % chunkSize != 0 || horizontalSize > 8192)
+        throw runtime_error("Horizontal size must be a multiple of the chunk size and at most 8192");
+    if (verticalSize <= 0 || verticalSize % chunkSize != 0 || verticalSize > 512)
+        throw runtime_error("Vertical size must be a multiple of the chunk size and at most 512");
+}
@@ -0,0 +1,119 @@
+#include "WorldFile.hpp"
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+#include "CompactColumns.hpp"
+#include "MappedFile.hpp"
+#include "WorldConfig.hpp"
+
+using namespace std;
+
+static constexpr char magic[8] = "VXWORLD";
+static constexpr int sectionCount = 5; // ys, ids, bottoms, rowStarts, offsets
+
+bool validIndex(const WorldConfig& world, const uint32_t* rowStarts, const uint16_t* offsets);
+bool validYs(const CompactColumnsView& columns);
+
+struct WorldFileHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t horizontalSize;
+    int32_t verticalSize;
+    int32_t chunkSize;
+    uint64_t generatorID;
+    uint64_t contentHash;
+    uint64_t sectionOffsets[sectionCount];
+    uint64_t sectionSizes[sectionCount];
+};
+
+
+WorldFile::WorldFile(char const* path) :
+    file(path, sizeof(WorldFileHeader)) {
+    // Check the header and the sections
+    const WorldFileHeader& header = *(const WorldFileHeader*)file.bytes();
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0) throw runtime_error(string("Not a world file: ") + path);
+    if (header.version != version) throw runtime_error(string("Unsupported world file version: ") + path);
+    WorldConfig world(header.horizontalSize, header.verticalSize, header.chunkSize);
+    for (int i = 0; i < sectionCount; i++) {
+        if (!file.validSection(header.sectionOffsets[i], header.sectionSizes[i])) throw runtime_error(string("Invalid world file sections: ") + path);
+    }
+    const uint8_t* bytes = file.bytes();
+    const uint32_t* rowStarts = (const uint32_t*)(bytes + header.sectionOffsets[3]);
+    const uint16_t* offsets = (const uint16_t*)(bytes + header.sectionOffsets[4]);
+    uint32_t rowCount = world.horizontalChunks * world.horizontalChunks * world.chunkSize;
+    if (header.sectionSizes[3] != (rowCount + 1) * sizeof(uint32_t)
+        || header.sectionSizes[2] != world.columnCount() * sizeof(uint16_t)
+        || header.sectionSizes[4] != world.columnCount() * sizeof(uint16_t)
+        || header.sectionSizes[0] != rowStarts[rowCount] * sizeof(uint16_t)
+        || header.sectionSizes[1] != rowStarts[rowCount] * sizeof(uint8_t))
+        throw runtime_error(string("Invalid world file section sizes: ") + path);
+    if (!validIndex(world, rowStarts, offsets)) throw runtime_error(string("Invalid world file column index: ") + path);
+
+    view = CompactColumnsView {
+        world,
+        (const uint16_t*)(bytes + header.sectionOffsets[0]),
+        bytes + header.sectionOffsets[1],
+        (const uint16_t*)(bytes + header.sectionOffsets[2]),
+        ColumnIndexView(rowStarts, offsets, world.chunkSize)
+    };
+    if (!validYs(view)) throw runtime_error(string("Invalid world file blocks: ") + path);
+    hash = header.contentHash;
+    generator = header.generatorID;
+}
+
+
+void WorldFile::save(char const* path, const CompactColumns& columns, uint64_t generatorID) {
+    const void* sections[sectionCount] = { columns.ys.data(), columns.ids.data(), columns.bottoms.data(), columns.index.rowStarts.data(), columns.index.offsets.data() };
+    WorldFileHeader header = {};
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.horizontalSize = columns.world.horizontalSize;
+    header.verticalSize = columns.world.verticalSize;
+    header.chunkSize = columns.world.chunkSize;
+    header.generatorID = generatorID;
+    header.contentHash = columns.contentHash();
+    header.sectionSizes[0] = columns.ys.size() * sizeof(uint16_t);
+    header.sectionSizes[1] = columns.ids.size() * sizeof(uint8_t);
+    header.sectionSizes[2] = columns.bottoms.size() * sizeof(uint16_t);
+    header.sectionSizes[3] = columns.index.rowStarts.size() * sizeof(uint32_t);
+    header.sectionSizes[4] = columns.index.offsets.size() * sizeof(uint16_t);
+    MappedFile::placeSections(sizeof(header), sectionCount, header.sectionSizes, header.sectionOffsets);
+    MappedFile::write(path, &header, sizeof(header), sectionCount, sections, header.sectionSizes, header.sectionOffsets);
+}
+
+
+// Check that the rows start in order from 0 and that each column starts in its row, after the previous one
+bool validIndex(const WorldConfig& world, const uint32_t* rowStarts, const uint16_t* offsets) {
+    uint32_t rowCount = world.horizontalChunks * world.horizontalChunks * world.chunkSize;
+    if (rowStarts[0] != 0) return false;
+    for (uint32_t row = 0; row < rowCount; row++) {
+        if (rowStarts[row + 1] < rowStarts[row]) return false;
+        uint32_t rowSize = rowStarts[row + 1] - rowStarts[row];
+        const uint16_t* rowOffsets = offsets + row * world.chunkSize;
+        if (rowOffsets[0] != 0) return false;
+        for (int x = 1; x < world.chunkSize; x++) {
+            if (rowOffsets[x] < rowOffsets[x - 1] || rowOffsets[x] > rowSize) return false;
+        }
+    }
+    return true;
+}
+
+
+// Check that the blocks of each column are in the world, from bottom to top (the mesher writes them at their y without checks)
+bool validYs(const CompactColumnsView& columns) {
+    int verticalSize = columns.world.verticalSize;
+    bool valid = true;
+    for (uint32_t xzIndex = 0; xzIndex < columns.world.columnCount(); xzIndex++) {
+        uint32_t start = columns.index.start(xzIndex);
+        uint32_t end = columns.index.end(xzIndex);
+        valid &= columns.bottoms[xzIndex] < verticalSize;
+        if (start == end) continue;
+        valid &= columns.ys[end - 1] < verticalSize;
+        for (uint32_t i = start + 1; i < end; i++) valid &= columns.ys[i - 1] < columns.ys[i];
+    }
+    return valid;
+}
@@ -1,8 +1,12 @@
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <memory>
+#include <vector>
+#include <stdexcept>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/string_cast.hpp>
@@ -14,8 +18,15 @@
 #include "VoxelMesh.hpp"
 #include "TerrainRenderer.hpp"
 #include "GenerateTerrain.hpp"
+#include "DensityGenerator.hpp"
 #include "GenerateMesh.hpp"
-#include "Constants.hpp"
+#include "MeshingContext.hpp"
+#include "CompactColumns.hpp"
+#include "WorldFile.hpp"
+#include "ChunkedColumns.hpp"
+#include "World.hpp"
+#include "MeshCache.hpp"
+#include "WorldConfig.hpp"
 #include "TerminalRenderer.hpp"
 #include "FPSCounter.hpp"
 
@@ -30,28 +41,73 @@ static constexpr int windowWidth = 1920;
 static constexpr int windowHeight = 1080;
 static constexpr const char* title = "Voxel Terrain";
 static constexpr float backgroundRed = 0, backgroundGreen = 0.8, backgroundBlue = 1.0;
+static constexpr const char* worldPath = "world.bin"; // Saved world (delete it to generate a new one)
+static constexpr const char* meshCachePath = "meshes.bin"; // Saved meshes of the saved world (regenerated when the world or the mesher changes)
+static constexpr float editDistance = 500; // Maximum distance of edited blocks from the camera
+static constexpr int placedBlockID = 3; // Color ID of placed blocks
+static constexpr int craterRadius = 16; // Radius of the spheres removed by middle clicks
+static constexpr size_t undoSnapshots = 64; // Number of edits that can be undone
 
 
-int main() {
-    // Generate terrain
-    vector<int> IDs;
-    uint32_t* IDIndexes = new uint32_t[HORIZONTAL_SIZE * HORIZONTAL_SIZE + 1];
-    generateTerrain(IDs, IDIndexes);
-    vector<VoxelMesh> meshes;
-    vector<Square> squares;
-    generateMesh(0, 0, HORIZONTAL_CHUNKS, HORIZONTAL_CHUNKS, IDs.data(), IDIndexes, meshes, squares);
-    delete[] IDIndexes;
+// Arguments (optional) : horizontal size, vertical size, chunk size, seed, levels of detail (0: off, faster meshing and fewer squares)
+// Left click : remove the block in front of the camera, right click : place a block against it, middle click : dig a crater around it, Z : undo the last edit
+int main(int argc, char** argv) {
+    // Load the saved terrain, or generate and save it
+    WorldConfig defaultWorld;
+    WorldConfig world(
+        argc > 1 ? atoi(argv[1]) : defaultWorld.horizontalSize,
+        argc > 2 ? atoi(argv[2]) : defaultWorld.verticalSize,
+        argc > 3 ? atoi(argv[3]) : defaultWorld.chunkSize
+    );
+    DensityGenerator generator(argc > 4 ? strtoul(argv[4], nullptr, 10) : 0);
+    bool levelsOfDetail = argc > 5 ? atoi(argv[5]) != 0 : true;
+    unique_ptr<WorldFile> savedWorld;
+    try {
+        savedWorld = make_unique<WorldFile>(worldPath);
+    }
+    catch (const runtime_error&) {} // Missing or invalid
+    if (savedWorld == nullptr || !(savedWorld->columns().world == world) || savedWorld->generatorID() != generator.id()) {
+        savedWorld = nullptr;
+        CompactColumns columns;
+        generateTerrain(generator, world, columns);
+        WorldFile::save(worldPath, columns, generator.id());
+        savedWorld = make_unique<WorldFile>(worldPath);
+    }
+
+    // Load the saved meshes of the terrain, or generate them
+    unique_ptr<MeshCache> savedMeshes;
+    try {
+        savedMeshes = make_unique<MeshCache>(meshCachePath);
+    }
+    catch (const runtime_error&) {} // Missing, invalid or from another mesher version
+    if (savedMeshes != nullptr && (savedMeshes->worldHash() != savedWorld->contentHash() || savedMeshes->levelsOfDetail() != levelsOfDetail)) savedMeshes = nullptr;
     
     // Initialize objects
     Window window(windowWidth, windowHeight, title);
     gl::init(windowWidth, windowHeight);
     Camera camera(windowWidth, windowHeight, 60, 0.1, 9999, vec3(0, 400, 0), pi<float>() / 6, pi<float>() / 4);
     CameraController controller(window, camera, windowWidth, windowHeight);
-    TerrainRenderer renderer(camera);
-    renderer.addMeshes(meshes, squares);
-    renderer.prepareRender();
+    TerrainRenderer renderer(camera, world, levelsOfDetail);
+    if (savedMeshes != nullptr) {
+        renderer.prepareRender(savedMeshes->meshData(), savedMeshes->meshCount(), savedMeshes->squares(), savedMeshes->squareCount());
+        savedMeshes = nullptr; // Uploaded, the mapping is not needed anymore
+    }
+    else {
+        MeshingContext context(true, levelsOfDetail);
+        generateMesh(0, 0, world.horizontalChunks, world.horizontalChunks, savedWorld->columns(), renderer.meshSink(), context); // Directly in the renderer, without intermediate copies
+        context.release();
+        renderer.prepareRender();
+        MeshCache::save(meshCachePath, savedWorld->contentHash(), levelsOfDetail, renderer.allMeshData().data(), renderer.allMeshData().size(), renderer.allSquares().data(), renderer.allSquares().size());
+    }
     TerminalRenderer terminal(stdout);
     FPSCounter fpsCounter(terminal);
+    unique_ptr<World> editedWorld; // Copy of the saved world, made at the first edit
+    MeshingContext editContext(true, levelsOfDetail);
+    bool removing = false;
+    bool placing = false;
+    bool digging = false;
+    bool undoing = false;
+    vector<ChunkedColumns> snapshots; // Snapshots of the world before the last edits (oldest first)
     
     // Main loop
     system_clock::time_point lastTime = system_clock::now();
@@ -63,6 +119,36 @@ int main() {
 
         // Update
         controller.update(deltaTime);
+
+        // Edit the block in front of the camera, then remesh the edited chunks into the renderer
+        bool remove = window.mouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT);
+        bool place = window.mouseButtonPressed(GLFW_MOUSE_BUTTON_RIGHT);
+        bool dig = window.mouseButtonPressed(GLFW_MOUSE_BUTTON_MIDDLE);
+        if ((remove && !removing) || (place && !placing) || (dig && !digging)) {
+            if (editedWorld == nullptr) editedWorld = make_unique<World>(savedWorld->columns(), DensityGenerator::blockID);
+            ivec3 hit, before;
+            if (editedWorld->raycast(camera.position, camera.orientation * vec3(0, 0, 1), editDistance, hit, before)) {
+                if (snapshots.size() == undoSnapshots) snapshots.erase(snapshots.begin());
+                snapshots.push_back(editedWorld->snapshot());
+                try {
+                    if (remove) editedWorld->removeBlock(hit.x, hit.y, hit.z);
+                    else if (dig) editedWorld->fillSphere(hit, craterRadius, World::air);
+                    else editedWorld->setBlock(before.x, before.y, before.z, placedBlockID);
+                }
+                catch (const runtime_error&) {} // Outside of the world
+            }
+            editedWorld->remesh(renderer.updateSink(), editContext);
+        }
+        bool undo = window.keyPressed(GLFW_KEY_Z);
+        if (undo && !undoing && !snapshots.empty()) {
+            editedWorld->restore(snapshots.back());
+            snapshots.pop_back();
+            editedWorld->remesh(renderer.updateSink(), editContext);
+        }
+        undoing = undo;
+        removing = remove;
+        placing = place;
+        digging = dig;
         gl::setBackground(backgroundRed, backgroundGreen, backgroundBlue);
         renderer.render();
         fpsCounter.update(deltaTime);
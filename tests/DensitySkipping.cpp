@@ -0,0 +1,66 @@
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "GenerateTerrain.hpp"
+#include "DensityGenerator.hpp"
+#include "CompactColumns.hpp"
+#include "WorldConfig.hpp"
+
+using namespace std;
+
+// Skipping the y intervals known to be air or solid must not change the generated blocks: the density generator must give
+// the same solid blocks with and without skipping, for runs of columns that don't start or end on a SIMD lane, and the same compact columns.
+
+static constexpr uint32_t seeds[] = { 0, 1, 1234567 };
+static constexpr int verticalSizes[] = { 64, 160, 256 }; // 160: last word of the columns partly used
+static constexpr int horizontalSize = 128;
+static constexpr int runStarts[] = { 0, 3, -45 }; // x of the first column of the runs of a row
+static constexpr int runLength = 123;
+
+int compareBlocks(const DensityGenerator& skipping, const DensityGenerator& evaluating, int verticalSize, uint64_t& solidBlocks);
+
+
+int main() {
+    int failures = 0;
+    for (uint32_t seed : seeds) {
+        for (int verticalSize : verticalSizes) {
+            DensityGenerator skipping(seed, true);
+            DensityGenerator evaluating(seed, false);
+            uint64_t solidBlocks = 0;
+            int differences = compareBlocks(skipping, evaluating, verticalSize, solidBlocks);
+
+            WorldConfig world(horizontalSize, verticalSize, 32);
+            CompactColumns skippedColumns, evaluatedColumns;
+            generateTerrain(skipping, world, skippedColumns);
+            generateTerrain(evaluating, world, evaluatedColumns);
+            bool sameColumns = skippedColumns.contentHash() == evaluatedColumns.contentHash();
+
+            printf("seed %u, height %d: %llu solid blocks, %d different, %s columns\n", seed, verticalSize, (unsigned long long)solidBlocks,
+                differences, sameColumns ? "same" : "different");
+            failures += differences != 0 || !sameColumns;
+        }
+    }
+    printf(failures == 0 ? "OK\n" : "FAILED (%d)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+
+// Number of different 64 bits words of solid blocks in runs of columns of each row
+int compareBlocks(const DensityGenerator& skipping, const DensityGenerator& evaluating, int verticalSize, uint64_t& solidBlocks) {
+    int words = DensityGenerator::wordCount(verticalSize);
+    vector<uint64_t> skipped(runLength * words);
+    vector<uint64_t> evaluated(runLength * words);
+    int differences = 0;
+    for (int z = -8; z < horizontalSize; z++) {
+        for (int startX : runStarts) {
+            skipping.generate(startX, z, runLength, verticalSize, skipped.data());
+            evaluating.generate(startX, z, runLength, verticalSize, evaluated.data());
+            for (int i = 0; i < runLength * words; i++) {
+                differences += skipped[i] != evaluated[i];
+                solidBlocks += __builtin_popcountll(evaluated[i]);
+            }
+        }
+    }
+    return differences;
+}
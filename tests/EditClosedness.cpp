@@ -0,0 +1,323 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "World.hpp"
+#include "GenerateMesh.hpp"
+#include "GenerateTerrain.hpp"
+#include "SineGenerator.hpp"
+#include "NoiseGenerator.hpp"
+#include "DensityGenerator.hpp"
+#include "CompactColumns.hpp"
+#include "VoxelMesh.hpp"
+#include "WorldConfig.hpp"
+
+using namespace std;
+using namespace glm;
+
+// Edits must keep the terrain closed: the same edits applied to the solid blocks of the generated terrain (dense reference)
+// must give the same solid blocks, and the solid blocks next to removed blocks must have full resolution faces on their side.
+
+static constexpr int neighbours[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+
+// Solid blocks of a world, edited like the world
+struct DenseBlocks {
+    WorldConfig world;
+    vector<uint8_t> solid; // index of (x, y, z) : y + (x + z * horizontalSize) * verticalSize
+    vector<ivec3> removed; // Blocks removed since the last check
+
+    bool inside(int x, int y, int z) const {
+        return x >= 0 && y >= 0 && z >= 0 && x < world.horizontalSize && y < world.verticalSize && z < world.horizontalSize;
+    }
+
+    bool at(int x, int y, int z) const {
+        return solid[y + (x + z * world.horizontalSize) * world.verticalSize] != 0;
+    }
+
+    void set(int x, int y, int z, bool value) {
+        if (!inside(x, y, z)) return;
+        uint8_t& block = solid[y + (x + z * world.horizontalSize) * world.verticalSize];
+        if (block && !value) removed.push_back(ivec3(x, y, z));
+        block = value;
+    }
+
+    int top(int x, int z) const { // Highest solid block of a column (-1 if none)
+        int y = world.verticalSize - 1;
+        while (y >= 0 && !at(x, y, z)) y--;
+        return y;
+    }
+};
+
+DenseBlocks heightFieldBlocks(const TerrainGenerator& generator, const WorldConfig& world);
+DenseBlocks densityBlocks(const DensityGenerator& generator, const WorldConfig& world);
+int checkSolid(const World& world, const DenseBlocks& blocks);
+int checkRemoved(const World& world, DenseBlocks& blocks);
+int testBlockEdits(World& world, DenseBlocks& blocks);
+int testBrushEdits(World& world, DenseBlocks& blocks);
+
+
+int main() {
+    int failures = 0;
+    WorldConfig world(128, 128, 32);
+    {
+        CompactColumns columns;
+        generateTerrain(SineGenerator(), world, columns);
+        World edited(columns.view(), [](int y, bool) { return NoiseGenerator::blockID(y); });
+        DenseBlocks blocks = heightFieldBlocks(SineGenerator(), world);
+        printf("Height field world:\n");
+        failures += testBlockEdits(edited, blocks);
+        failures += testBrushEdits(edited, blocks);
+    }
+    {
+        CompactColumns columns;
+        generateTerrain(DensityGenerator(), world, columns);
+        World edited(columns.view(), DensityGenerator::blockID);
+        DenseBlocks blocks = densityBlocks(DensityGenerator(), world);
+        printf("Density world:\n");
+        failures += testBlockEdits(edited, blocks);
+        failures += testBrushEdits(edited, blocks);
+    }
+    printf(failures == 0 ? "OK\n" : "FAILED (%d)\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+
+// Blocks up to the height of each column (clamped to the world like generateTerrain())
+DenseBlocks heightFieldBlocks(const TerrainGenerator& generator, const WorldConfig& world) {
+    DenseBlocks blocks { world, vector<uint8_t>((size_t)world.columnCount() * world.verticalSize, 0), {} };
+    vector<int> heights(world.horizontalSize);
+    vector<int> ids(world.horizontalSize);
+    for (int z = 0; z < world.horizontalSize; z++) {
+        generator.generate(0, z, world.horizontalSize, heights.data(), ids.data());
+        for (int x = 0; x < world.horizontalSize; x++) {
+            for (int y = 0; y <= std::min(heights[x], world.verticalSize - 1); y++) blocks.set(x, y, z, true);
+        }
+    }
+    return blocks;
+}
+
+
+DenseBlocks densityBlocks(const DensityGenerator& generator, const WorldConfig& world) {
+    DenseBlocks blocks { world, vector<uint8_t>((size_t)world.columnCount() * world.verticalSize, 0), {} };
+    int words = DensityGenerator::wordCount(world.verticalSize);
+    vector<uint64_t> solid(world.horizontalSize * words);
+    for (int z = 0; z < world.horizontalSize; z++) {
+        fill(solid.begin(), solid.end(), 0);
+        generator.generate(0, z, world.horizontalSize, world.verticalSize, solid.data());
+        for (int x = 0; x < world.horizontalSize; x++) {
+            for (int y = 0; y < world.verticalSize; y++) blocks.set(x, y, z, (solid[x * words + y / 64] >> (y % 64)) & 1);
+        }
+    }
+    return blocks;
+}
+
+
+// Number of blocks that are solid in the world and not in the reference or the opposite
+int checkSolid(const World& world, const DenseBlocks& blocks) {
+    int differences = 0;
+    for (int z = 0; z < blocks.world.horizontalSize; z++) {
+        for (int x = 0; x < blocks.world.horizontalSize; x++) {
+            for (int y = 0; y < blocks.world.verticalSize; y++) differences += (world.block(x, y, z) != World::air) != blocks.at(x, y, z);
+        }
+    }
+    if (differences != 0) printf("    %d blocks with another solidity than the reference\n", differences);
+    return differences;
+}
+
+
+// Number of solid blocks next to blocks removed since the last check without a face on the side of the removed block
+int checkRemoved(const World& world, DenseBlocks& blocks) {
+    const WorldConfig& config = blocks.world;
+    vector<VoxelMesh> meshes;
+    vector<Square> squares;
+    generateMesh(0, 0, config.horizontalChunks, config.horizontalChunks, world.columns(), meshes, squares, 1);
+
+    // Faces of the full resolution meshes (block and normal)
+    unordered_set<uint64_t> faces;
+    auto faceKey = [](int x, int y, int z, int normal) { return (uint64_t)x | ((uint64_t)z << 13) | ((uint64_t)y << 26) | ((uint64_t)normal << 36); };
+    uint32_t start = 0;
+    for (const VoxelMesh& mesh : meshes) {
+        for (uint32_t i = start; i < start + mesh.squaresCount && mesh.lod == 0; i++) {
+            uint32_t data[2];
+            memcpy(data, &squares[i], sizeof(data));
+            int position[3] = { (int)(data[0] & 8191), (int)((data[1] & 511) | ((data[0] >> 28) & 1) << 9), (int)((data[0] >> 13) & 8191) };
+            int width = ((data[1] >> 9) & 63) + 1;
+            int height = ((data[1] >> 15) & 63) + 1;
+            int normal = (data[1] >> 21) & 7;
+            uint32_t normalAxis = axis((CubeNormal)normal);
+            position[normalAxis] -= normalPositive((CubeNormal)normal);
+            for (int u = 0; u < width; u++) {
+                for (int v = 0; v < height; v++) {
+                    int block[3] = { position[0], position[1], position[2] };
+                    block[widthAxis(normalAxis)] += u;
+                    block[heightAxis(normalAxis)] += v;
+                    faces.insert(faceKey(block[0], block[1], block[2], normal));
+                }
+            }
+        }
+        start += mesh.squaresCount;
+    }
+
+    int missing = 0;
+    for (ivec3 removed : blocks.removed) {
+        if (blocks.at(removed.x, removed.y, removed.z)) continue; // Placed again
+        for (int normal = 0; normal < 6; normal++) {
+            ivec3 block = removed + ivec3(neighbours[normal][0], neighbours[normal][1], neighbours[normal][2]);
+            if (!blocks.inside(block.x, block.y, block.z) || !blocks.at(block.x, block.y, block.z)) continue;
+            missing += faces.count(faceKey(block.x, block.y, block.z, normal ^ 1)) == 0;
+        }
+    }
+    blocks.removed.clear();
+    if (missing != 0) printf("    %d missing faces next to removed blocks\n", missing);
+    return missing;
+}
+
+
+// Dig a shaft block by block, then remove and place blocks at random positions on the surface (like main())
+int testBlockEdits(World& world, DenseBlocks& blocks) {
+    const WorldConfig& config = blocks.world;
+    int failures = checkSolid(world, blocks);
+    blocks.removed.clear();
+
+    // Shaft in the highest column
+    int x = 0;
+    int z = 0;
+    int top = 0;
+    for (int columnZ = 0; columnZ < config.horizontalSize; columnZ++) {
+        for (int columnX = 0; columnX < config.horizontalSize; columnX++) {
+            int y = blocks.top(columnX, columnZ);
+            if (y <= top) continue;
+            x = columnX;
+            z = columnZ;
+            top = y;
+        }
+    }
+    for (int y = top; y > std::max(top - 40, 0); y--) {
+        world.removeBlock(x, y, z);
+        blocks.set(x, y, z, false);
+        failures += checkRemoved(world, blocks);
+    }
+    printf("    shaft of %d blocks: %s\n", top - std::max(top - 40, 0), failures == 0 ? "closed" : "open");
+
+    srand(21);
+    for (int edit = 0; edit < 200; edit++) {
+        ivec3 hit, before;
+        vec3 origin(rand() % config.horizontalSize + 0.5f, config.verticalSize - 0.5f, rand() % config.horizontalSize + 0.5f);
+        if (!world.raycast(origin, vec3(0.3f, -1, 0.2f) / length(vec3(0.3f, -1, 0.2f)), 1000, hit, before)) continue;
+        if (edit % 3 != 0) {
+            world.removeBlock(hit.x, hit.y, hit.z);
+            blocks.set(hit.x, hit.y, hit.z, false);
+        }
+        else if (blocks.inside(before.x, before.y, before.z)) {
+            world.setBlock(before.x, before.y, before.z, 1 + edit % 4);
+            blocks.set(before.x, before.y, before.z, true);
+        }
+        if (edit % 20 == 0) failures += checkRemoved(world, blocks);
+    }
+    failures += checkRemoved(world, blocks);
+    failures += checkSolid(world, blocks);
+    printf("    random edits: %s\n", failures == 0 ? "closed" : "open");
+    return failures;
+}
+
+
+// Boxes, spheres and height stamps on the surface, in the middle of the world and on its borders
+int testBrushEdits(World& world, DenseBlocks& blocks) {
+    const WorldConfig& config = blocks.world;
+    int failures = 0;
+    auto report = [&](const char* name) {
+        int editFailures = checkRemoved(world, blocks);
+        editFailures += checkSolid(world, blocks);
+        printf("    %s: %s\n", name, editFailures == 0 ? "closed" : "open");
+        failures += editFailures;
+    };
+    auto fillBox = [&](ivec3 min, ivec3 max, int id) {
+        world.fillBox(min, max, id);
+        for (int z = min.z; z <= max.z; z++) {
+            for (int x = min.x; x <= max.x; x++) {
+                for (int y = min.y; y <= max.y; y++) blocks.set(x, y, z, id != World::air);
+            }
+        }
+    };
+    auto fillSphere = [&](ivec3 center, int radius, int id) {
+        world.fillSphere(center, radius, id);
+        for (int z = center.z - radius; z <= center.z + radius; z++) {
+            for (int x = center.x - radius; x <= center.x + radius; x++) {
+                for (int y = center.y - radius; y <= center.y + radius; y++) {
+                    ivec3 offset = ivec3(x, y, z) - center;
+                    if (offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <= radius * radius) blocks.set(x, y, z, id != World::air);
+                }
+            }
+        }
+    };
+
+    int middle = config.horizontalSize / 2;
+    int last = config.horizontalSize - 1;
+    int surface = blocks.top(middle, middle);
+    fillBox(ivec3(middle - 6, surface - 12, middle - 5), ivec3(middle + 5, surface + 2, middle + 7), World::air);
+    fillBox(ivec3(-3, blocks.top(0, 0) - 8, -3), ivec3(4, config.verticalSize - 1, 6), World::air);
+    fillBox(ivec3(last - 4, 0, middle), ivec3(last + 3, blocks.top(last, middle) - 3, middle + 3), World::air);
+    report("air boxes");
+
+    fillBox(ivec3(middle - 3, surface - 15, middle - 8), ivec3(middle + 2, surface - 4, middle + 1), 5);
+    fillBox(ivec3(last - 2, blocks.top(last, 10), 8), ivec3(last + 2, blocks.top(last, 10) + 4, 12), 6);
+    report("block boxes");
+
+    srand(22);
+    for (int sphere = 0; sphere < 12; sphere++) {
+        int x = sphere < 3 ? sphere * last / 2 : rand() % config.horizontalSize;
+        int z = sphere < 3 ? last - sphere * last / 2 : rand() % config.horizontalSize;
+        fillSphere(ivec3(x, blocks.top(x, z), z), 10 + sphere % 7, World::air);
+    }
+    report("craters");
+
+    fillSphere(ivec3(middle, blocks.top(middle, middle) - 2, middle), 6, 7);
+    fillSphere(ivec3(last, blocks.top(last, last), last), 5, 8);
+    report("block spheres");
+
+    // Height fields raising and lowering the terrain, with the same rule as stampHeights() for the blocks below the heights
+    for (int stamp = 0; stamp < 4; stamp++) {
+        int sizeX = 12 + stamp * 4;
+        int sizeZ = 20 - stamp * 3;
+        int startX = stamp == 3 ? last - sizeX / 2 : rand() % (config.horizontalSize - sizeX);
+        int startZ = stamp == 3 ? -sizeZ / 2 : rand() % (config.horizontalSize - sizeZ);
+        vector<int> heights(sizeX * sizeZ);
+        for (int z = 0; z < sizeZ; z++) {
+            for (int x = 0; x < sizeX; x++) {
+                int base = blocks.inside(startX + x, 0, startZ + z) ? blocks.top(startX + x, startZ + z) : config.verticalSize / 2;
+                heights[x + z * sizeX] = std::clamp(base + (stamp % 2 == 0 ? 6 : -10) + rand() % 7 - 3, 0, config.verticalSize - 1);
+            }
+        }
+        auto height = [&](int x, int z) {
+            if (x >= startX && z >= startZ && x < startX + sizeX && z < startZ + sizeZ) return heights[x - startX + (z - startZ) * sizeX];
+            return blocks.top(x, z);
+        };
+        vector<ivec2> bottoms; // Lowest stamped block of each column (computed before changing the reference)
+        for (int z = std::max(startZ, 0); z < std::min(startZ + sizeZ, config.horizontalSize); z++) {
+            for (int x = std::max(startX, 0); x < std::min(startX + sizeX, config.horizontalSize); x++) {
+                int bottom = height(x, z);
+                for (int normal = 0; normal < 6; normal++) {
+                    int neighbourX = x + neighbours[normal][0];
+                    int neighbourZ = z + neighbours[normal][2];
+                    if (neighbours[normal][1] == 0 && blocks.inside(neighbourX, 0, neighbourZ)) bottom = std::min(bottom, height(neighbourX, neighbourZ) + 1);
+                }
+                bottoms.push_back(ivec2(bottom, height(x, z)));
+            }
+        }
+        world.stampHeights(startX, startZ, sizeX, sizeZ, heights.data(), 9);
+        int i = 0;
+        for (int z = std::max(startZ, 0); z < std::min(startZ + sizeZ, config.horizontalSize); z++) {
+            for (int x = std::max(startX, 0); x < std::min(startX + sizeX, config.horizontalSize); x++, i++) {
+                for (int y = bottoms[i].x; y < config.verticalSize; y++) blocks.set(x, y, z, y <= bottoms[i].y);
+            }
+        }
+    }
+    report("height stamps");
+    return failures;
+}
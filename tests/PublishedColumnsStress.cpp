@@ -0,0 +1,154 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "World.hpp"
+#include "GenerateMesh.hpp"
+#include "GenerateTerrain.hpp"
+#include "DensityGenerator.hpp"
+#include "PublishedColumns.hpp"
+#include "MeshingContext.hpp"
+#include "MeshSink.hpp"
+#include "WorldConfig.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace glm;
+
+// Meshing threads read published columns while a writer edits the world and publishes it: chunk columns must not change
+// (or be released) while a reader reads them, replaced chunk columns must all be released once the readers stop, also when
+// meshing throws, and the last published version must mesh like the world.
+
+static constexpr int runMilliseconds = 2000;
+static constexpr uint32_t readerCount = 4;
+
+
+// Count and hash the squares of the meshes
+class HashMeshSink : public MeshSink {
+public:
+    uint64_t squareCount = 0;
+    uint64_t hash = 0;
+
+    void addMeshes(uint32_t, uint32_t, const VoxelMesh*, uint32_t, const Square* squares, uint32_t count) override {
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t data;
+            memcpy(&data, &squares[i], sizeof(data));
+            hash = hash * 31 + data;
+        }
+        squareCount += count;
+    }
+};
+
+
+// Fail while meshing
+class ThrowingMeshSink : public MeshSink {
+public:
+    void addMeshes(uint32_t, uint32_t, const VoxelMesh*, uint32_t, const Square*, uint32_t) override {
+        throw runtime_error("Sink full");
+    }
+};
+
+
+int main() {
+    int failures = 0;
+    WorldConfig config(256, 256, 32);
+    CompactColumns generated;
+    generateTerrain(DensityGenerator(), config, generated);
+    World world(generated.view(), DensityGenerator::blockID);
+    PublishedColumns published(world.columns(), readerCount + 1); // The last reader is the main thread
+    uint32_t horizontalChunks = config.horizontalChunks;
+
+    atomic<bool> stop(false);
+    atomic<uint64_t> meshedChunks(0);
+    atomic<uint64_t> changedChunks(0);
+    vector<thread> readers;
+    for (uint32_t reader = 0; reader < readerCount; reader++) {
+        readers.emplace_back([&, reader] {
+            MeshingContext context(false);
+            HashMeshSink sink;
+            mt19937 random(reader);
+            while (!stop.load()) {
+                uint32_t sizeX = 1 + random() % 3;
+                uint32_t sizeZ = 1 + random() % 3;
+                uint32_t x = random() % (horizontalChunks - sizeX + 1);
+                uint32_t z = random() % (horizontalChunks - sizeZ + 1);
+                generateMesh(x, z, sizeX, sizeZ, published, reader, sink, context, 1);
+                meshedChunks += sizeX * sizeZ;
+
+                PublishedRead read(published, reader);
+                const CompactColumns& chunk = published.chunk(random() % (horizontalChunks * horizontalChunks));
+                uint64_t hash = chunk.contentHash();
+                this_thread::yield();
+                changedChunks += chunk.contentHash() != hash;
+            }
+        });
+    }
+
+    // Writer: edit, publish, and mesh its own edits
+    mt19937 random(24);
+    MeshingContext context(false);
+    HashMeshSink writerSink;
+    uint64_t edits = 0;
+    uint64_t replaced = 0;
+    size_t maxRetired = 0;
+    steady_clock::time_point start = steady_clock::now();
+    while (duration_cast<milliseconds>(steady_clock::now() - start).count() < runMilliseconds) {
+        ivec3 position(random() % config.horizontalSize, random() % config.verticalSize, random() % config.horizontalSize);
+        int id = random() % 2 ? World::air : 1 + random() % 255;
+        if (random() % 4 == 0) world.fillSphere(position, 4 + random() % 12, id);
+        else world.fillBox(position, position, id);
+        replaced += published.publish(world.columns());
+        maxRetired = std::max(maxRetired, published.retiredCount());
+        world.remesh(writerSink, context);
+        edits++;
+    }
+    stop = true;
+    for (thread& reader : readers) reader.join();
+    published.reclaim();
+    printf("%u readers meshed %llu chunk columns while %llu edits replaced %llu chunk columns (at most %zu not released)\n", readerCount,
+        (unsigned long long)meshedChunks.load(), (unsigned long long)edits, (unsigned long long)replaced, maxRetired);
+
+    if (changedChunks.load() != 0) {
+        printf("    %llu chunk columns changed while read\n", (unsigned long long)changedChunks.load());
+        failures++;
+    }
+    if (published.retiredCount() != 0) {
+        printf("    %zu chunk columns not released after the readers stopped\n", published.retiredCount());
+        failures++;
+    }
+
+    // The reader must stop reading when meshing throws
+    ThrowingMeshSink throwingSink;
+    bool thrown = false;
+    try {
+        generateMesh(0, 0, horizontalChunks, horizontalChunks, published, readerCount, throwingSink, context, 1);
+    }
+    catch (const runtime_error&) {
+        thrown = true;
+    }
+    world.fillSphere(ivec3(config.horizontalSize / 2, config.verticalSize / 2, config.horizontalSize / 2), 20, World::air);
+    published.publish(world.columns());
+    if (!thrown || published.retiredCount() != 0) {
+        printf("    %zu chunk columns not released after meshing threw\n", published.retiredCount());
+        failures++;
+    }
+
+    HashMeshSink publishedSink;
+    HashMeshSink worldSink;
+    generateMesh(0, 0, horizontalChunks, horizontalChunks, published, readerCount, publishedSink, context, 1);
+    generateMesh(0, 0, horizontalChunks, horizontalChunks, world.columns(), worldSink, context, 1);
+    if (publishedSink.squareCount != worldSink.squareCount || publishedSink.hash != worldSink.hash) {
+        printf("    the published columns don't mesh like the world\n");
+        failures++;
+    }
+
+    printf(failures == 0 ? "OK\n" : "FAILED (%d)\n", failures);
+    return failures == 0 ? 0 : 1;
+}